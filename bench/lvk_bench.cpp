@@ -0,0 +1,506 @@
+// Frame-time benchmark: renders a deterministic scene for a fixed number of frames and prints
+// CPU-side timings as JSON. Runs headless by default so it works on software ICDs (lavapipe).
+//
+//   lvk_bench [--objects N] [--models N] [--width W] [--height H] [--frames N] [--warmup N]
+//             [--frame-policy balanced|throughput|low-latency] [--frames-in-flight N] [--seed N]
+//             [--mesh FILE]... [--threads N] [--no-instancing] [--parallel-record]
+//             [--gpu-trace FILE] [--trace FILE] [--windowed] [--out FILE|-]
+//
+// --frame-policy picks frames in flight, present mode and whether input waits for the GPU (see
+// LvkFramePolicy); --frames-in-flight overrides the policy's count. Run once per policy to compare
+// them: fps is the throughput, inputLatency the time from sampling input to the GPU finishing
+// the frame that used it. Scan-out is not included, so on a display add up to a refresh interval.
+// depth reports the per-frame-in-flight depth images and the memory saved over one per swap image.
+//
+// --mesh (repeatable) replaces the generated polygons with models loaded from .obj/.gltf files
+// through their .lvkmesh caches, in parallel on --threads job workers (0 = one per core).
+// sceneLoadMs in the output covers loading and uploading the scene, pipelineCreateMs building the
+// render system's pipeline (fast when pipelineCacheLoaded, i.e. the on-disk cache was valid).
+// --parallel-record records draws into secondary command buffers on the --threads job workers.
+// gpuFrame/gpuMainPass are timestamp-query timings; --gpu-trace also writes them, together with
+// upload batches, as a Chrome trace (chrome://tracing, ui.perfetto.dev).
+// --trace writes CPU zones as a Chrome trace; it needs a build with -DLVK_ENABLE_TRACING=ON.
+// Results go to lvk_bench.json unless --out is given ("-" for stdout; the device logs to stdout too).
+// Like newexec, shaders are loaded from ../shaders, so run it from the build directory.
+
+#include "lvk_window.hpp"
+#include "lvk_asset_loader.hpp"
+#include "lvk_device.hpp"
+#include "lvk_renderer.hpp"
+#include "lvk_model.hpp"
+#include "lvk_game_object_store.hpp"
+#include "lvk_transform_kernel.hpp"
+#include "lvk_trace.hpp"
+#include "simple_render_system.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+//std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double msSince(Clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    struct BenchConfig {
+        uint32_t objectCount = 1000;
+        uint32_t modelCount = 16;
+        uint32_t width = 1280;
+        uint32_t height = 720;
+        uint32_t frames = 1000;
+        uint32_t warmupFrames = 50;
+        std::string framePolicy = "balanced";
+        // 0 keeps the policy's own count
+        uint32_t framesInFlight = 0;
+        uint32_t seed = 1337;
+        bool windowed = false;
+        bool instanced = true;
+        bool parallelRecord = false;
+        std::vector<std::string> meshPaths;
+        uint32_t threads = 0;
+        std::string gpuTracePath;
+        std::string tracePath;
+        std::string outPath = "lvk_bench.json";
+    };
+
+    struct FrameSample {
+        double frameMs;
+        double waitMs;
+        double recordMs;
+        double submitMs;
+        double presentMs;
+        double gpuFrameMs;
+        double gpuMainPassMs;
+        double inputLatencyMs;
+    };
+
+    // Waits for each submitted frame on its own thread, so completion is timed exactly rather
+    // than whenever the render loop next gets round to checking.
+    class LatencyProbe {
+    public:
+        explicit LatencyProbe(lvk::LvkTimeline &timeline) : timeline{timeline}, thread{[this] { run(); }} {}
+        ~LatencyProbe() { finish(); }
+
+        LatencyProbe(const LatencyProbe &) = delete;
+        LatencyProbe &operator=(const LatencyProbe &) = delete;
+
+        void submitted(uint64_t timelineValue, Clock::time_point inputTime) {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                pending.push_back({timelineValue, inputTime});
+            }
+            pendingChanged.notify_one();
+        }
+
+        // Latencies in submission order, once every submitted frame has completed.
+        const std::vector<double> &finish() {
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                stopping = true;
+            }
+            pendingChanged.notify_one();
+            if (thread.joinable()) {
+                thread.join();
+            }
+            return latenciesMs;
+        }
+
+    private:
+        struct Frame {
+            uint64_t timelineValue;
+            Clock::time_point inputTime;
+        };
+
+        void run() {
+            std::unique_lock<std::mutex> lock{mutex};
+            while (true) {
+                pendingChanged.wait(lock, [this] { return stopping || !pending.empty(); });
+                if (pending.empty()) {
+                    return;
+                }
+                Frame frame = pending.front();
+                pending.pop_front();
+                lock.unlock();
+                timeline.wait(frame.timelineValue);
+                latenciesMs.push_back(msSince(frame.inputTime));
+                lock.lock();
+            }
+        }
+
+        lvk::LvkTimeline &timeline;
+        std::mutex mutex;
+        std::condition_variable pendingChanged;
+        std::deque<Frame> pending;
+        bool stopping = false;
+        std::vector<double> latenciesMs;
+        std::thread thread;
+    };
+
+
+    uint32_t parseCount(const std::string &flag, const char *value) {
+        char *end = nullptr;
+        long parsed = std::strtol(value, &end, 10);
+        if (end == value || *end != '\0' || parsed < 0) {
+            throw std::runtime_error("invalid value for " + flag + ": " + value);
+        }
+        return static_cast<uint32_t>(parsed);
+    }
+
+    BenchConfig parseArgs(int argc, char **argv) {
+        BenchConfig config{};
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--windowed") {
+                config.windowed = true;
+                continue;
+            }
+            if (arg == "--no-instancing") {
+                config.instanced = false;
+                continue;
+            }
+            if (arg == "--parallel-record") {
+                config.parallelRecord = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                throw std::runtime_error("missing value for " + arg);
+            }
+            const char *value = argv[++i];
+            if (arg == "--objects") config.objectCount = parseCount(arg, value);
+            else if (arg == "--models") config.modelCount = parseCount(arg, value);
+            else if (arg == "--width") config.width = parseCount(arg, value);
+            else if (arg == "--height") config.height = parseCount(arg, value);
+            else if (arg == "--frames") config.frames = parseCount(arg, value);
+            else if (arg == "--warmup") config.warmupFrames = parseCount(arg, value);
+            else if (arg == "--frame-policy") config.framePolicy = value;
+            else if (arg == "--frames-in-flight") config.framesInFlight = parseCount(arg, value);
+            else if (arg == "--seed") config.seed = parseCount(arg, value);
+            else if (arg == "--mesh") config.meshPaths.emplace_back(value);
+            else if (arg == "--threads") config.threads = parseCount(arg, value);
+            else if (arg == "--gpu-trace") config.gpuTracePath = value;
+            else if (arg == "--trace") config.tracePath = value;
+            else if (arg == "--out") config.outPath = value;
+            else throw std::runtime_error("unknown argument: " + arg);
+        }
+        if (!config.tracePath.empty() && !lvk::LvkTrace::ENABLED) {
+            throw std::runtime_error("--trace needs a build configured with -DLVK_ENABLE_TRACING=ON");
+        }
+        if (config.modelCount == 0 || config.frames == 0 || config.width == 0 || config.height == 0) {
+            throw std::runtime_error("--models, --frames, --width and --height must be non-zero");
+        }
+        // validates the name before any device is created
+        lvk::LvkFramePolicy::fromName(config.framePolicy);
+        if (config.framesInFlight > lvk::LvkFramePolicy::MAX_FRAMES_IN_FLIGHT) {
+            throw std::runtime_error(
+                    "--frames-in-flight must be at most " + std::to_string(lvk::LvkFramePolicy::MAX_FRAMES_IN_FLIGHT));
+        }
+        return config;
+    }
+
+    // Model i is a regular polygon with 3 + (i % 14) sides, built as a triangle fan and indexed.
+    std::shared_ptr<lvk::LvkModel> createPolygonModel(lvk::LvkDevice &device, uint32_t index) {
+        const uint32_t sides = 3 + (index % 14);
+        const glm::vec3 tint{
+                0.3f + 0.7f * static_cast<float>(index % 3) / 2.f,
+                0.3f + 0.7f * static_cast<float>(index % 5) / 4.f,
+                0.3f + 0.7f * static_cast<float>(index % 7) / 6.f};
+        std::vector<lvk::LvkModel::Vertex> vertices;
+        vertices.reserve(sides * 3);
+        for (uint32_t s = 0; s < sides; s++) {
+            float a0 = glm::two_pi<float>() * static_cast<float>(s) / static_cast<float>(sides);
+            float a1 = glm::two_pi<float>() * static_cast<float>(s + 1) / static_cast<float>(sides);
+            vertices.push_back({{0.f, 0.f}, tint});
+            vertices.push_back({{0.5f * glm::cos(a0), 0.5f * glm::sin(a0)}, tint});
+            vertices.push_back({{0.5f * glm::cos(a1), 0.5f * glm::sin(a1)}, tint});
+        }
+        return std::make_shared<lvk::LvkModel>(device, lvk::LvkModel::Builder::fromTriangleList(vertices));
+    }
+
+    lvk::LvkGameObjectStore createScene(lvk::LvkDevice &device, const BenchConfig &config) {
+        std::vector<std::shared_ptr<lvk::LvkModel>> models;
+        if (!config.meshPaths.empty()) {
+            lvk::LvkJobSystem jobSystem{config.threads};
+            lvk::LvkAssetLoader assetLoader{device, jobSystem};
+            models = assetLoader.loadModels(config.meshPaths);
+        } else {
+            models.reserve(config.modelCount);
+            for (uint32_t i = 0; i < config.modelCount; i++) {
+                models.push_back(createPolygonModel(device, i));
+            }
+        }
+
+        std::mt19937 rng{config.seed};
+        std::uniform_real_distribution<float> position{-1.f, 1.f};
+        std::uniform_real_distribution<float> size{0.01f, 0.05f};
+        std::uniform_real_distribution<float> unit{0.f, 1.f};
+
+        lvk::LvkGameObjectStore gameObjects;
+        std::vector<lvk::LvkGameObjectStore::ModelHandle> handles;
+        for (auto &model : models) {
+            handles.push_back(gameObjects.registerModel(model));
+        }
+        gameObjects.reserve(config.objectCount);
+        for (uint32_t i = 0; i < config.objectCount; i++) {
+            glm::vec3 color{unit(rng), unit(rng), unit(rng)};
+            lvk::Transform2dComponent transform{};
+            transform.translation = {position(rng), position(rng)};
+            float s = size(rng);
+            transform.scale = {s, s};
+            transform.rotation = unit(rng) * glm::two_pi<float>();
+            gameObjects.create(handles[i % handles.size()], color, transform);
+        }
+        return gameObjects;
+    }
+
+    struct Summary {
+        double mean = 0.0;
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    Summary summarize(std::vector<double> values) {
+        Summary summary{};
+        if (values.empty()) {
+            return summary;
+        }
+        std::sort(values.begin(), values.end());
+        auto percentile = [&values](double p) {
+            size_t rank = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size())));
+            return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+        };
+        double total = 0.0;
+        for (double v : values) total += v;
+        summary.mean = total / static_cast<double>(values.size());
+        summary.p50 = percentile(0.50);
+        summary.p95 = percentile(0.95);
+        summary.p99 = percentile(0.99);
+        summary.max = values.back();
+        return summary;
+    }
+
+    template<typename Field>
+    void writeSummary(std::ostream &out, const char *name, const std::vector<FrameSample> &samples,
+                      Field field, bool last) {
+        std::vector<double> values;
+        values.reserve(samples.size());
+        for (const auto &sample : samples) values.push_back(sample.*field);
+        Summary s = summarize(std::move(values));
+        out << "    \"" << name << "\": {\"mean\": " << s.mean << ", \"p50\": " << s.p50
+            << ", \"p95\": " << s.p95 << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << "}"
+            << (last ? "\n" : ",\n");
+    }
+
+    void writeJson(std::ostream &out, const BenchConfig &config, const lvk::LvkFramePolicy &policy,
+                   lvk::LvkDevice &device, const lvk::LvkSwapChain::DepthMemory &depth,
+                   const std::vector<FrameSample> &samples, bool gpuTimestamps, double sceneLoadMs, double pipelineCreateMs, double totalMs) {
+        auto memory = device.allocator().getStats();
+        out << "{\n";
+        out << "  \"device\": \"" << device.properties.deviceName << "\",\n";
+        out << "  \"transformKernel\": \"" << lvk::transformKernelName() << "\",\n";
+        out << "  \"gpuTimestamps\": " << (gpuTimestamps ? "true" : "false") << ",\n";
+        out << "  \"config\": {\"objects\": " << config.objectCount << ", \"models\": " << config.modelCount
+            << ", \"width\": " << config.width << ", \"height\": " << config.height
+            << ", \"frames\": " << config.frames << ", \"warmup\": " << config.warmupFrames
+            << ", \"framePolicy\": \"" << policy.name << "\", \"framesInFlight\": " << policy.framesInFlight
+            << ", \"seed\": " << config.seed
+            << ", \"headless\": " << (config.windowed ? "false" : "true")
+            << ", \"instanced\": " << (config.instanced ? "true" : "false")
+            << ", \"parallelRecord\": " << (config.parallelRecord ? "true" : "false")
+            << ", \"meshes\": " << config.meshPaths.size() << ", \"threads\": " << config.threads << "},\n";
+        out << "  \"memory\": {\"blocks\": " << memory.blockCount
+            << ", \"dedicatedBlocks\": " << memory.dedicatedBlockCount
+            << ", \"allocations\": " << memory.allocationCount
+            << ", \"bytesReserved\": " << memory.bytesReserved
+            << ", \"bytesInUse\": " << memory.bytesInUse
+            << ", \"freeRanges\": " << memory.freeRangeCount
+            << ", \"fragmentation\": " << memory.fragmentation << "},\n";
+        out << "  \"depth\": {\"images\": " << depth.imageCount << ", \"bytes\": " << depth.bytes
+            << ", \"lazilyAllocated\": " << (depth.lazilyAllocated ? "true" : "false")
+            << ", \"bytesSaved\": " << depth.bytesSaved << "},\n";
+        out << "  \"sceneLoadMs\": " << sceneLoadMs << ",\n";
+        out << "  \"pipelineCreateMs\": " << pipelineCreateMs << ",\n";
+        out << "  \"pipelineCacheLoaded\": " << (device.pipelineCache().wasLoaded() ? "true" : "false") << ",\n";
+        out << "  \"totalMs\": " << totalMs << ",\n";
+        out << "  \"fps\": " << (totalMs > 0.0 ? 1000.0 * samples.size() / totalMs : 0.0) << ",\n";
+        out << "  \"ms\": {\n";
+        writeSummary(out, "frame", samples, &FrameSample::frameMs, false);
+        writeSummary(out, "acquireWait", samples, &FrameSample::waitMs, false);
+        writeSummary(out, "record", samples, &FrameSample::recordMs, false);
+        writeSummary(out, "submit", samples, &FrameSample::submitMs, false);
+        writeSummary(out, "presentWait", samples, &FrameSample::presentMs, false);
+        writeSummary(out, "gpuFrame", samples, &FrameSample::gpuFrameMs, false);
+        writeSummary(out, "gpuMainPass", samples, &FrameSample::gpuMainPassMs, false);
+        writeSummary(out, "inputLatency", samples, &FrameSample::inputLatencyMs, true);
+        out << "  }\n";
+        out << "}\n";
+    }
+
+    void runBenchmark(const BenchConfig &config) {
+        auto policy = lvk::LvkFramePolicy::fromName(config.framePolicy);
+        if (config.framesInFlight != 0) {
+            policy.framesInFlight = config.framesInFlight;
+        }
+        std::unique_ptr<lvk::LvkWindow> window;
+        std::unique_ptr<lvk::LvkDevice> device;
+        std::unique_ptr<lvk::LvkRenderer> renderer;
+        if (config.windowed) {
+            window = std::make_unique<lvk::LvkWindow>(
+                    static_cast<int>(config.width), static_cast<int>(config.height), "lvk_bench");
+            device = std::make_unique<lvk::LvkDevice>(*window);
+            renderer = std::make_unique<lvk::LvkRenderer>(*window, *device, policy);
+        } else {
+            device = std::make_unique<lvk::LvkDevice>();
+            renderer = std::make_unique<lvk::LvkRenderer>(*device, VkExtent2D{config.width, config.height}, policy);
+        }
+
+        auto &frameProfiler = renderer->gpuProfiler();
+        auto &uploadProfiler = device->uploadQueue().gpuProfiler();
+        if (!config.gpuTracePath.empty()) {
+            frameProfiler.setTraceCapture(true);
+            uploadProfiler.setTraceCapture(true);
+        }
+
+        auto loadStart = Clock::now();
+        auto gameObjects = createScene(*device, config);
+        // keep the one-off geometry upload out of the measured frames
+        device->uploadQueue().waitIdle();
+        double sceneLoadMs = msSince(loadStart);
+        std::unique_ptr<lvk::LvkJobSystem> recordJobs;
+        if (config.parallelRecord) {
+            recordJobs = std::make_unique<lvk::LvkJobSystem>(config.threads);
+        }
+        auto pipelineStart = Clock::now();
+        lvk::SimpleRenderSystem simpleRenderSystem{
+                *device,
+                renderer->getSwapChainRenderPass(),
+                renderer->getFramePolicy().framesInFlight,
+                config.instanced,
+                recordJobs.get()};
+        // with a job system the pipelines compile in the background; keep that out of the frames
+        device->pipelineRegistry().waitForCompiles();
+        double pipelineCreateMs = msSince(pipelineStart);
+
+        std::vector<FrameSample> samples;
+        samples.reserve(config.frames);
+        const uint32_t totalFrames = config.warmupFrames + config.frames;
+        Clock::time_point measureStart{};
+        Clock::time_point lastFrameStart = Clock::now();
+        uint32_t frame = 0;
+        LatencyProbe latencyProbe{device->graphicsTimeline()};
+        LVK_TRACE_THREAD_NAME("main");
+        while (frame < totalFrames) {
+            renderer->waitBeforeInput();
+            if (window) {
+                if (window->shouldClose()) break;
+                window->pollEvents();
+            }
+            // headless there is no input, but this is where it would be read
+            auto inputTime = Clock::now();
+            if (frame == config.warmupFrames) {
+                measureStart = Clock::now();
+            }
+            LVK_TRACE_ZONE("frame");
+            auto frameStart = Clock::now();
+            auto commandBuffer = renderer->beginFrame();
+            if (!commandBuffer) {
+                continue;
+            }
+            auto recordStart = Clock::now();
+            {
+                LVK_TRACE_ZONE("record");
+                LVK_GPU_SCOPE(frameProfiler, commandBuffer, "mainPass");
+                renderer->beginSwapChainRenderPass(commandBuffer, simpleRenderSystem.subpassContents());
+                lvk::FrameInfo frameInfo{
+                        renderer->getFrameIndex(),
+                        commandBuffer,
+                        renderer->getSwapChainRenderPass(),
+                        renderer->getCurrentFramebuffer(),
+                        renderer->getExtent()};
+                simpleRenderSystem.renderGameObjects(frameInfo, gameObjects);
+                renderer->endSwapChainRenderPass(commandBuffer);
+            }
+            double recordMs = msSince(recordStart);
+            renderer->endFrame();
+
+            if (frame >= config.warmupFrames) {
+                const auto &timings = renderer->getLastFrameTimings();
+                samples.push_back({
+                        std::chrono::duration<double, std::milli>(frameStart - lastFrameStart).count(),
+                        timings.fenceWaitMs + timings.acquireMs,
+                        recordMs,
+                        timings.submitMs,
+                        timings.presentMs,
+                        frameProfiler.latestMs("frame"),
+                        frameProfiler.latestMs("mainPass"),
+                        0.0});
+                latencyProbe.submitted(renderer->getLastFrameValue(), inputTime);
+            }
+            lastFrameStart = frameStart;
+            frame++;
+        }
+        vkDeviceWaitIdle(device->device());
+        double totalMs = samples.empty() ? 0.0 : msSince(measureStart);
+        const auto &latenciesMs = latencyProbe.finish();
+        for (size_t i = 0; i < samples.size(); i++) {
+            samples[i].inputLatencyMs = latenciesMs[i];
+        }
+
+        if (!config.tracePath.empty()) {
+            std::ofstream trace{config.tracePath};
+            if (!trace.is_open()) {
+                throw std::runtime_error("failed to open " + config.tracePath);
+            }
+            lvk::LvkTrace::writeChromeTrace(trace);
+        }
+        if (!config.gpuTracePath.empty()) {
+            std::ofstream trace{config.gpuTracePath};
+            if (!trace.is_open()) {
+                throw std::runtime_error("failed to open " + config.gpuTracePath);
+            }
+            lvk::LvkGpuProfiler::writeChromeTrace(trace, {&frameProfiler, &uploadProfiler});
+        }
+
+        if (config.outPath == "-") {
+            writeJson(std::cout, config, policy, *device, renderer->getDepthMemory(), samples, frameProfiler.isSupported(), sceneLoadMs, pipelineCreateMs, totalMs);
+        } else {
+            std::ofstream out{config.outPath};
+            if (!out.is_open()) {
+                throw std::runtime_error("failed to open " + config.outPath);
+            }
+            writeJson(out, config, policy, *device, renderer->getDepthMemory(), samples, frameProfiler.isSupported(), sceneLoadMs, pipelineCreateMs, totalMs);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    try {
+        runBenchmark(parseArgs(argc, argv));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,7 @@
 #include "app.hpp"
 #include "simple_render_system.hpp"
+#include "lvk_shader_hot_reload.hpp"
+#include "lvk_trace.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -16,22 +18,43 @@ namespace lvk {
 
     App::App(){
         loadGameObjects();
+        lvkDevice.uploadQueue().flush();
     }
 
     App::~App(){ }
 
     void App::run() {
-        SimpleRenderSystem simpleRenderSystem{lvkDevice, lvkRenderer.getSwapChainRenderPass()};
+        SimpleRenderSystem simpleRenderSystem{
+                lvkDevice, lvkRenderer.getSwapChainRenderPass(), lvkRenderer.getFramePolicy().framesInFlight};
+        std::unique_ptr<LvkShaderHotReload> shaderHotReload;
+        if (LvkShaderHotReload::SUPPORTED) {
+            shaderHotReload = std::make_unique<LvkShaderHotReload>(lvkDevice);
+        }
+        LVK_TRACE_THREAD_NAME("main");
         while(!lvkWindow.shouldClose()) {
-            glfwPollEvents();
+            LVK_TRACE_ZONE("frame");
+            lvkRenderer.waitBeforeInput();
+            lvkWindow.pollEvents();
+            if (shaderHotReload) {
+                shaderHotReload->update();
+            }
             if (auto commandBuffer = lvkRenderer.beginFrame()){
-                lvkRenderer.beginSwapChainRenderPass(commandBuffer);
-                simpleRenderSystem.renderGameObjects(commandBuffer, gameObjects);
+                lvkRenderer.beginSwapChainRenderPass(commandBuffer, simpleRenderSystem.subpassContents());
+                FrameInfo frameInfo{
+                        lvkRenderer.getFrameIndex(),
+                        commandBuffer,
+                        lvkRenderer.getSwapChainRenderPass(),
+                        lvkRenderer.getCurrentFramebuffer(),
+                        lvkRenderer.getExtent()};
+                simpleRenderSystem.renderGameObjects(frameInfo, gameObjects);
                 lvkRenderer.endSwapChainRenderPass(commandBuffer);
                 lvkRenderer.endFrame();
             }
         }
         vkDeviceWaitIdle(lvkDevice.device());
+        if (LvkTrace::ENABLED) {
+            LvkTrace::writeChromeTraceFromEnv();
+        }
     }
 
     void App::loadGameObjects() {
@@ -42,15 +65,12 @@ namespace lvk {
                 {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}},
         };
 
-        auto lvkModel = std::make_shared<LvkModel>(lvkDevice, vertices);
-
-        auto triangle = LvkGameObject::createGameObject();
-        triangle.model = lvkModel;
-        triangle.color = {.1f, .8f, .1f};
-        triangle.transform2d.translation.x = .2f;
-        triangle.transform2d.scale = {2.f, .5f};
-        triangle.transform2d.rotation = .1f * glm::two_pi<float>();
+        auto lvkModel = gameObjects.registerModel(std::make_shared<LvkModel>(lvkDevice, vertices));
 
-        gameObjects.push_back(std::move(triangle));
+        Transform2dComponent transform{};
+        transform.translation.x = .2f;
+        transform.scale = {2.f, .5f};
+        transform.rotation = .1f * glm::two_pi<float>();
+        gameObjects.create(lvkModel, {.1f, .8f, .1f}, transform);
     }
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "lvk_device.hpp"
 #include "lvk_renderer.hpp"
 #include "lvk_model.hpp"
-#include "lvk_game_object.hpp"
+#include "lvk_game_object_store.hpp"
 //std
 #include <memory>
 #include <vector>
@@ -26,8 +26,8 @@ namespace lvk {
 
         LvkWindow lvkWindow{WIDTH, HEIGHT, "First app"};
         LvkDevice lvkDevice{lvkWindow};
-        LvkRenderer lvkRenderer{lvkWindow, lvkDevice};
+        LvkRenderer lvkRenderer{lvkWindow, lvkDevice, LvkFramePolicy::fromEnv()};
 
-        std::vector<LvkGameObject> gameObjects;
+        LvkGameObjectStore gameObjects;
     };
 }
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "lvk_allocator.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+namespace lvk {
+
+    namespace {
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        // True if the last byte of a resource ending at aEnd and the first byte of one starting
+        // at bStart fall on the same bufferImageGranularity page.
+        bool onSamePage(VkDeviceSize aEnd, VkDeviceSize bStart, VkDeviceSize granularity) {
+            return ((aEnd - 1) & ~(granularity - 1)) == (bStart & ~(granularity - 1));
+        }
+    }
+
+    class LvkMemoryBlock {
+    public:
+        struct Range {
+            VkDeviceSize size;
+            bool free;
+            bool linear;
+        };
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize size = 0;
+        void *mapped = nullptr;
+        uint32_t memoryTypeIndex = 0;
+        bool dedicated = false;
+        uint32_t allocationCount = 0;
+        VkDeviceSize bytesInUse = 0;
+        // offset -> range; the ranges tile the whole block and no two free ranges are adjacent
+        std::map<VkDeviceSize, Range> ranges;
+
+        bool tryAllocate(VkDeviceSize allocSize, VkDeviceSize alignment, bool linear,
+                         VkDeviceSize granularity, VkDeviceSize &outOffset) {
+            auto best = ranges.end();
+            VkDeviceSize bestOffset = 0;
+            for (auto it = ranges.begin(); it != ranges.end(); ++it) {
+                if (!it->second.free || it->second.size < allocSize) continue;
+                if (best != ranges.end() && it->second.size >= best->second.size) continue;
+
+                VkDeviceSize start = alignUp(it->first, alignment);
+                if (granularity > 1 && it != ranges.begin()) {
+                    auto prev = std::prev(it);
+                    if (prev->second.linear != linear && onSamePage(it->first, start, granularity)) {
+                        start = alignUp(start, granularity);
+                    }
+                }
+                VkDeviceSize end = start + allocSize;
+                if (end > it->first + it->second.size) continue;
+
+                auto next = std::next(it);
+                if (granularity > 1 && next != ranges.end() && next->second.linear != linear &&
+                    onSamePage(end, next->first, granularity)) {
+                    continue;
+                }
+                best = it;
+                bestOffset = start;
+            }
+            if (best == ranges.end()) {
+                return false;
+            }
+
+            VkDeviceSize rangeOffset = best->first;
+            VkDeviceSize rangeEnd = best->first + best->second.size;
+            if (bestOffset > rangeOffset) {
+                best->second.size = bestOffset - rangeOffset;
+            } else {
+                ranges.erase(best);
+            }
+            ranges[bestOffset] = Range{allocSize, false, linear};
+            if (bestOffset + allocSize < rangeEnd) {
+                ranges[bestOffset + allocSize] = Range{rangeEnd - bestOffset - allocSize, true, false};
+            }
+            allocationCount++;
+            bytesInUse += allocSize;
+            outOffset = bestOffset;
+            return true;
+        }
+
+        void release(VkDeviceSize offset) {
+            auto it = ranges.find(offset);
+            assert(it != ranges.end() && !it->second.free && "Freeing an allocation that is not live");
+            it->second.free = true;
+            allocationCount--;
+            bytesInUse -= it->second.size;
+
+            auto next = std::next(it);
+            if (next != ranges.end() && next->second.free) {
+                it->second.size += next->second.size;
+                ranges.erase(next);
+            }
+            if (it != ranges.begin()) {
+                auto prev = std::prev(it);
+                if (prev->second.free) {
+                    prev->second.size += it->second.size;
+                    ranges.erase(it);
+                }
+            }
+        }
+    };
+
+    LvkAllocator::LvkAllocator(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize preferredBlockSize)
+            : device{device}, preferredBlockSize{preferredBlockSize} {
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+        bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+        blocks.resize(memoryProperties.memoryTypeCount);
+    }
+
+    LvkAllocator::~LvkAllocator() {
+        for (auto &typeBlocks : blocks) {
+            for (auto &block : typeBlocks) {
+                if (block->mapped != nullptr) {
+                    vkUnmapMemory(device, block->memory);
+                }
+                vkFreeMemory(device, block->memory, nullptr);
+            }
+        }
+    }
+
+    uint32_t LvkAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) &&
+                (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return i;
+            }
+        }
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    bool LvkAllocator::hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+            if ((typeFilter & (1 << i)) &&
+                (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    VkDeviceSize LvkAllocator::blockSizeFor(uint32_t memoryTypeIndex) const {
+        // small heaps (e.g. the 256MB BAR window) should not be eaten by a handful of blocks
+        uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+        VkDeviceSize heapSize = memoryProperties.memoryHeaps[heapIndex].size;
+        return std::min(preferredBlockSize, std::max<VkDeviceSize>(heapSize / 8, 1024 * 1024));
+    }
+
+    LvkAllocation LvkAllocator::allocate(
+            const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, bool linear) {
+        std::lock_guard<std::mutex> lock{mutex};
+        uint32_t memoryTypeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+        VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+        VkDeviceSize blockSize = blockSizeFor(memoryTypeIndex);
+
+        LvkMemoryBlock *target = nullptr;
+        VkDeviceSize offset = 0;
+        if (requirements.size > blockSize / 2) {
+            target = createBlock(memoryTypeIndex, requirements.size, requirements.size, true);
+            target->tryAllocate(requirements.size, alignment, linear, bufferImageGranularity, offset);
+        } else {
+            for (auto &block : blocks[memoryTypeIndex]) {
+                if (!block->dedicated &&
+                    block->tryAllocate(requirements.size, alignment, linear, bufferImageGranularity, offset)) {
+                    target = block.get();
+                    break;
+                }
+            }
+            if (target == nullptr) {
+                target = createBlock(memoryTypeIndex, blockSize, requirements.size, false);
+                if (!target->tryAllocate(requirements.size, alignment, linear, bufferImageGranularity, offset)) {
+                    throw std::runtime_error("failed to sub-allocate from a fresh memory block!");
+                }
+            }
+        }
+
+        LvkAllocation allocation{};
+        allocation.memory = target->memory;
+        allocation.offset = offset;
+        allocation.size = requirements.size;
+        allocation.mapped = target->mapped == nullptr ? nullptr : static_cast<char *>(target->mapped) + offset;
+        allocation.block = target;
+        return allocation;
+    }
+
+    void LvkAllocator::free(LvkAllocation &allocation) {
+        if (allocation.block == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{mutex};
+        LvkMemoryBlock *block = allocation.block;
+        block->release(allocation.offset);
+        allocation = LvkAllocation{};
+
+        if (block->allocationCount > 0) {
+            return;
+        }
+        if (block->dedicated) {
+            destroyBlock(block);
+            return;
+        }
+        // keep one empty block per memory type around so alloc/free churn does not hit the driver
+        for (auto &other : blocks[block->memoryTypeIndex]) {
+            if (other.get() != block && !other->dedicated && other->allocationCount == 0) {
+                destroyBlock(block);
+                return;
+            }
+        }
+    }
+
+    LvkMemoryBlock *LvkAllocator::createBlock(
+            uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceSize minSize, bool dedicated) {
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+        auto block = std::make_unique<LvkMemoryBlock>();
+        VkResult result = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        // retry with smaller blocks before giving up, the heap may just be too full for a big one
+        for (VkDeviceSize attempt = size; attempt >= minSize; attempt /= 2) {
+            allocInfo.allocationSize = attempt;
+            result = vkAllocateMemory(device, &allocInfo, nullptr, &block->memory);
+            if (result == VK_SUCCESS || attempt == minSize) break;
+            if (attempt / 2 < minSize) attempt = minSize * 2;
+        }
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate device memory block!");
+        }
+
+        block->size = allocInfo.allocationSize;
+        block->memoryTypeIndex = memoryTypeIndex;
+        block->dedicated = dedicated;
+        block->ranges[0] = LvkMemoryBlock::Range{block->size, true, false};
+        if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            if (vkMapMemory(device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS) {
+                vkFreeMemory(device, block->memory, nullptr);
+                throw std::runtime_error("failed to map device memory block!");
+            }
+        }
+
+        blocks[memoryTypeIndex].push_back(std::move(block));
+        return blocks[memoryTypeIndex].back().get();
+    }
+
+    void LvkAllocator::destroyBlock(LvkMemoryBlock *block) {
+        auto &typeBlocks = blocks[block->memoryTypeIndex];
+        auto it = std::find_if(typeBlocks.begin(), typeBlocks.end(),
+                               [block](const auto &candidate) { return candidate.get() == block; });
+        assert(it != typeBlocks.end() && "Block does not belong to this allocator");
+        if (block->mapped != nullptr) {
+            vkUnmapMemory(device, block->memory);
+        }
+        vkFreeMemory(device, block->memory, nullptr);
+        typeBlocks.erase(it);
+    }
+
+    LvkAllocator::Stats LvkAllocator::getStats() const {
+        std::lock_guard<std::mutex> lock{mutex};
+        Stats stats{};
+        VkDeviceSize freeBytes = 0;
+        for (const auto &typeBlocks : blocks) {
+            for (const auto &block : typeBlocks) {
+                stats.blockCount++;
+                if (block->dedicated) stats.dedicatedBlockCount++;
+                stats.allocationCount += block->allocationCount;
+                stats.bytesReserved += block->size;
+                stats.bytesInUse += block->bytesInUse;
+                for (const auto &[offset, range] : block->ranges) {
+                    if (!range.free) continue;
+                    stats.freeRangeCount++;
+                    freeBytes += range.size;
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, range.size);
+                }
+            }
+        }
+        if (freeBytes > 0) {
+            stats.fragmentation = 1.f - static_cast<float>(stats.largestFreeRange) / static_cast<float>(freeBytes);
+        }
+        return stats;
+    }
+}
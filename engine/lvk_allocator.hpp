@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lvk {
+    class LvkMemoryBlock;
+
+    // A sub-range of a device memory block. HOST_VISIBLE blocks stay mapped for their whole
+    // lifetime, so mapped already points at offset and must not be passed to vkMapMemory.
+    struct LvkAllocation {
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void *mapped = nullptr;
+        LvkMemoryBlock *block = nullptr;
+    };
+
+    // Carves buffers and images out of large vkAllocateMemory blocks, one pool per memory type.
+    class LvkAllocator {
+    public:
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+        struct Stats {
+            uint32_t blockCount = 0;
+            uint32_t dedicatedBlockCount = 0;
+            uint32_t allocationCount = 0;
+            VkDeviceSize bytesReserved = 0;
+            VkDeviceSize bytesInUse = 0;
+            uint32_t freeRangeCount = 0;
+            VkDeviceSize largestFreeRange = 0;
+            // 0 when all free space is one contiguous range, approaching 1 as it splinters
+            float fragmentation = 0.f;
+        };
+
+        LvkAllocator(VkPhysicalDevice physicalDevice, VkDevice device,
+                     VkDeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE);
+        ~LvkAllocator();
+
+        LvkAllocator(const LvkAllocator &) = delete;
+        LvkAllocator &operator=(const LvkAllocator &) = delete;
+
+        // linear is true for buffers and LINEAR images; it drives bufferImageGranularity padding.
+        LvkAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, bool linear);
+        void free(LvkAllocation &allocation);
+
+        Stats getStats() const;
+        uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+        // Like findMemoryType, for optional properties: false instead of throwing when none match.
+        bool hasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+    private:
+        LvkMemoryBlock *createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, VkDeviceSize minSize, bool dedicated);
+        void destroyBlock(LvkMemoryBlock *block);
+        VkDeviceSize blockSizeFor(uint32_t memoryTypeIndex) const;
+
+        VkDevice device;
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        VkDeviceSize bufferImageGranularity = 1;
+        VkDeviceSize preferredBlockSize;
+
+        std::vector<std::vector<std::unique_ptr<LvkMemoryBlock>>> blocks;
+        mutable std::mutex mutex;
+    };
+}
@@ -0,0 +1,49 @@
+#include "lvk_asset_loader.hpp"
+
+//std
+#include <atomic>
+#include <thread>
+
+namespace lvk {
+
+    namespace {
+        struct PendingMesh {
+            LvkModel::LoadedMesh mesh;
+            LvkJobSystem::Counter done;
+        };
+    }
+
+    LvkAssetLoader::LvkAssetLoader(LvkDevice &device, LvkJobSystem &jobSystem)
+            : lvkDevice{device}, jobSystem{jobSystem} {}
+
+    std::vector<std::shared_ptr<LvkModel>> LvkAssetLoader::loadModels(const std::vector<std::string> &filepaths) {
+        std::vector<PendingMesh> pending(filepaths.size());
+        for (size_t i = 0; i < filepaths.size(); i++) {
+            PendingMesh &slot = pending[i];
+            const std::string &filepath = filepaths[i];
+            jobSystem.submit([&slot, &filepath] { slot.mesh = LvkModel::loadMeshFile(filepath); }, &slot.done);
+        }
+
+        std::vector<std::shared_ptr<LvkModel>> models;
+        models.reserve(filepaths.size());
+        try {
+            for (auto &slot : pending) {
+                // helps with the remaining parses while this one is still in flight
+                jobSystem.wait(slot.done);
+                models.push_back(std::make_shared<LvkModel>(lvkDevice, slot.mesh.data));
+                // the data now lives in staging memory, drop the parsed copy / mapping early
+                slot.mesh = LvkModel::LoadedMesh{};
+            }
+        } catch (...) {
+            // the jobs reference pending and filepaths, so they must all finish before unwinding
+            for (auto &slot : pending) {
+                while (!slot.done.isDone()) {
+                    std::this_thread::yield();
+                }
+            }
+            throw;
+        }
+        lvkDevice.uploadQueue().flush();
+        return models;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "lvk_device.hpp"
+#include "lvk_job_system.hpp"
+#include "lvk_model.hpp"
+
+//std
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lvk {
+
+    // Loads many model files at once. Parsing, deduplication and cache I/O run as jobs on every
+    // core; the calling thread turns finished meshes into LvkModels in order, so it stays the only
+    // thread that records into (and submits) the upload queue.
+    class LvkAssetLoader {
+    public:
+        LvkAssetLoader(LvkDevice &device, LvkJobSystem &jobSystem);
+
+        LvkAssetLoader(const LvkAssetLoader &) = delete;
+        LvkAssetLoader &operator=(const LvkAssetLoader &) = delete;
+
+        // Result i belongs to filepaths[i]. Uploads are flushed but not waited on; check
+        // LvkModel::isReady() or the upload queue before relying on the data.
+        std::vector<std::shared_ptr<LvkModel>> loadModels(const std::vector<std::string> &filepaths);
+
+    private:
+        LvkDevice &lvkDevice;
+        LvkJobSystem &jobSystem;
+    };
+}
@@ -0,0 +1,66 @@
+#include "lvk_command_allocator.hpp"
+
+//std
+#include <cassert>
+#include <stdexcept>
+
+namespace lvk {
+
+    namespace {
+        size_t levelSlot(VkCommandBufferLevel level) {
+            return level == VK_COMMAND_BUFFER_LEVEL_PRIMARY ? 0 : 1;
+        }
+    }
+
+    LvkCommandAllocator::LvkCommandAllocator(LvkDevice &device, uint32_t threadCount, uint32_t framesInFlight)
+            : lvkDevice{device}, threadCount_{threadCount}, pools(static_cast<size_t>(threadCount) * framesInFlight) {
+        assert(threadCount > 0 && framesInFlight > 0 && "Command allocator needs at least one thread and frame");
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = lvkDevice.findPhysicalQueueFamilies().graphicsFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        for (auto &p : pools) {
+            if (vkCreateCommandPool(lvkDevice.device(), &poolInfo, nullptr, &p.pool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create per-frame command pool!");
+            }
+        }
+    }
+
+    LvkCommandAllocator::~LvkCommandAllocator() {
+        // destroying a pool frees every buffer allocated from it
+        for (auto &p : pools) {
+            vkDestroyCommandPool(lvkDevice.device(), p.pool, nullptr);
+        }
+    }
+
+    void LvkCommandAllocator::beginFrame(int frameIndex) {
+        currentFrame = frameIndex;
+        for (uint32_t thread = 0; thread < threadCount_; thread++) {
+            Pool &p = pool(frameIndex, thread);
+            if (p.used[0] == 0 && p.used[1] == 0) continue;
+            vkResetCommandPool(lvkDevice.device(), p.pool, 0);
+            p.used[0] = 0;
+            p.used[1] = 0;
+        }
+    }
+
+    VkCommandBuffer LvkCommandAllocator::allocate(uint32_t threadIndex, VkCommandBufferLevel level) {
+        assert(threadIndex < threadCount_ && "Thread index out of range for this command allocator");
+        Pool &p = pool(currentFrame, threadIndex);
+        const size_t slot = levelSlot(level);
+        auto &buffers = p.buffers[slot];
+        if (p.used[slot] == buffers.size()) {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = level;
+            allocInfo.commandPool = p.pool;
+            allocInfo.commandBufferCount = 1;
+            VkCommandBuffer commandBuffer;
+            if (vkAllocateCommandBuffers(lvkDevice.device(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate command buffer!");
+            }
+            buffers.push_back(commandBuffer);
+        }
+        return buffers[p.used[slot]++];
+    }
+}
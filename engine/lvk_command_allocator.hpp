@@ -0,0 +1,43 @@
+#pragma once
+
+#include "lvk_device.hpp"
+
+//std
+#include <vector>
+
+namespace lvk {
+
+    // One command pool per (frame in flight, recording thread). Pools are never shared between
+    // threads, so recording needs no locks, and instead of freeing individual buffers a frame's
+    // pools are reset wholesale once its submission has completed. Buffers handed out since the last
+    // reset are reused in order, so steady-state frames allocate nothing.
+    class LvkCommandAllocator {
+    public:
+        LvkCommandAllocator(LvkDevice &device, uint32_t threadCount, uint32_t framesInFlight);
+        ~LvkCommandAllocator();
+
+        LvkCommandAllocator(const LvkCommandAllocator &) = delete;
+        LvkCommandAllocator &operator=(const LvkCommandAllocator &) = delete;
+
+        // Resets every pool of frameIndex. The GPU must be done with that frame's buffers.
+        void beginFrame(int frameIndex);
+        // Only the thread owning threadIndex may call this between two beginFrame calls.
+        VkCommandBuffer allocate(uint32_t threadIndex, VkCommandBufferLevel level);
+
+        uint32_t threadCount() const { return threadCount_; }
+
+    private:
+        struct Pool {
+            VkCommandPool pool = VK_NULL_HANDLE;
+            std::vector<VkCommandBuffer> buffers[2];
+            size_t used[2] = {0, 0};
+        };
+
+        Pool &pool(int frameIndex, uint32_t threadIndex) { return pools[frameIndex * threadCount_ + threadIndex]; }
+
+        LvkDevice &lvkDevice;
+        uint32_t threadCount_;
+        int currentFrame = 0;
+        std::vector<Pool> pools;
+    };
+}
@@ -0,0 +1,61 @@
+#include "lvk_deletion_queue.hpp"
+
+//std
+#include <cassert>
+#include <vector>
+
+namespace lvk {
+
+    LvkDeletionQueue::~LvkDeletionQueue() {
+        assert(entries.empty() && "flush the deletion queue before destroying it");
+    }
+
+    void LvkDeletionQueue::enqueue(std::function<void()> deleter) {
+        std::lock_guard<std::mutex> lock{mutex};
+        entries.push_back({NOT_SUBMITTED, std::move(deleter)});
+    }
+
+    void LvkDeletionQueue::markSubmitted(uint64_t timelineValue) {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto entry = entries.rbegin(); entry != entries.rend() && entry->timelineValue == NOT_SUBMITTED; ++entry) {
+            entry->timelineValue = timelineValue;
+        }
+    }
+
+    void LvkDeletionQueue::collect(uint64_t completedValue) {
+        std::vector<std::function<void()>> ready;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            while (!entries.empty() && entries.front().timelineValue <= completedValue &&
+                   entries.front().timelineValue != NOT_SUBMITTED) {
+                ready.push_back(std::move(entries.front().deleter));
+                entries.pop_front();
+            }
+        }
+        for (auto &deleter : ready) {
+            deleter();
+        }
+    }
+
+    void LvkDeletionQueue::flush() {
+        // a deleter may release the last reference to something that enqueues its own deleter
+        while (true) {
+            std::deque<Entry> all;
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                all.swap(entries);
+            }
+            if (all.empty()) {
+                return;
+            }
+            for (auto &entry : all) {
+                entry.deleter();
+            }
+        }
+    }
+
+    size_t LvkDeletionQueue::pendingCount() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return entries.size();
+    }
+}
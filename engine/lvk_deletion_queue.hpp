@@ -0,0 +1,47 @@
+#pragma once
+
+//std
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+namespace lvk {
+    // Defers destroying GPU objects until the submissions that may still use them have finished, so
+    // nothing has to wait for the device to go idle. A deleter waits for the first graphics timeline
+    // value reported through markSubmitted after it was enqueued, normally that of the frame being
+    // recorded, and runs once collect sees the timeline reach it. Until something reports a
+    // submission, deleters wait for flush().
+    class LvkDeletionQueue {
+    public:
+        LvkDeletionQueue() = default;
+        ~LvkDeletionQueue();
+
+        LvkDeletionQueue(const LvkDeletionQueue &) = delete;
+        LvkDeletionQueue &operator=(const LvkDeletionQueue &) = delete;
+
+        // Thread-safe. Deleters run outside the lock, so they may enqueue more work.
+        void enqueue(std::function<void()> deleter);
+        // Everything enqueued so far was last used by submissions up to timelineValue.
+        void markSubmitted(uint64_t timelineValue);
+        // Runs the deleters whose timeline value is no later than completedValue.
+        void collect(uint64_t completedValue);
+        // Runs every deleter. Only call once the device is idle.
+        void flush();
+
+        size_t pendingCount();
+
+    private:
+        static constexpr uint64_t NOT_SUBMITTED = std::numeric_limits<uint64_t>::max();
+
+        struct Entry {
+            uint64_t timelineValue;
+            std::function<void()> deleter;
+        };
+
+        std::mutex mutex;
+        // values only grow towards the back, so the ready entries are always at the front
+        std::deque<Entry> entries;
+    };
+}
@@ -1,10 +1,14 @@
 #include "lvk_device.hpp"
+#include "lvk_pipeline_registry.hpp"
 
 // std headers
+#include <cassert>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <unordered_set>
+#include <utility>
 
 namespace lvk {
 
@@ -47,24 +51,52 @@ void DestroyDebugUtilsMessengerEXT(
 }
 
 // class member functions
-LvkDevice::LvkDevice(LvkWindow &window) : window{window} {
+LvkDevice::LvkDevice(LvkWindow &window) : window{&window} {
   createInstance();
   setupDebugMessenger();
   createSurface();
   pickPhysicalDevice();
   createLogicalDevice();
+  createAllocator();
   createCommandPool();
+  createUploadQueue();
+  createPipelineCache();
+  createPipelineRegistry();
+}
+
+LvkDevice::LvkDevice() : deviceExtensions{} {
+  createInstance();
+  setupDebugMessenger();
+  pickPhysicalDevice();
+  createLogicalDevice();
+  createAllocator();
+  createCommandPool();
+  createUploadQueue();
+  createPipelineCache();
+  createPipelineRegistry();
 }
 
 LvkDevice::~LvkDevice() {
+  vkDeviceWaitIdle(device_);
+  pipelineRegistry_.reset();
+  // the registry, and every owner destroyed before the device, queued their destruction here
+  deletionQueue_->flush();
+  pipelineCache_.reset();
+  uploadQueue_.reset();
+  allocator_.reset();
   vkDestroyCommandPool(device_, commandPool, nullptr);
+  computeTimeline_.reset();
+  transferTimeline_.reset();
+  graphicsTimeline_.reset();
   vkDestroyDevice(device_, nullptr);
 
   if (enableValidationLayers) {
     DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
   }
 
-  vkDestroySurfaceKHR(instance, surface_, nullptr);
+  if (surface_ != VK_NULL_HANDLE) {
+    vkDestroySurfaceKHR(instance, surface_, nullptr);
+  }
   vkDestroyInstance(instance, nullptr);
 }
 
@@ -79,7 +111,7 @@ void LvkDevice::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "No Engine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  appInfo.apiVersion = VK_API_VERSION_1_2;
 
   VkInstanceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -137,7 +169,11 @@ void LvkDevice::createLogicalDevice() {
   QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-  std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+  std::set<uint32_t> uniqueQueueFamilies = {
+      indices.graphicsFamily, indices.transferFamily, indices.computeFamily};
+  if (!isHeadless()) {
+    uniqueQueueFamilies.insert(indices.presentFamily);
+  }
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -152,8 +188,13 @@ void LvkDevice::createLogicalDevice() {
   VkPhysicalDeviceFeatures deviceFeatures = {};
   deviceFeatures.samplerAnisotropy = VK_TRUE;
 
+  VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+  timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  timelineFeatures.timelineSemaphore = VK_TRUE;
+
   VkDeviceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+  createInfo.pNext = &timelineFeatures;
 
   createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -176,7 +217,27 @@ void LvkDevice::createLogicalDevice() {
   }
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
-  vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+  if (!isHeadless()) {
+    vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+  }
+  graphicsTimeline_ = std::make_unique<LvkTimeline>(device_, graphicsQueue_);
+
+  transferQueue_ = graphicsQueue_;
+  if (indices.hasDedicatedTransfer()) {
+    vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+    transferTimeline_ = std::make_unique<LvkTimeline>(device_, transferQueue_);
+  }
+  computeQueue_ = graphicsQueue_;
+  if (indices.hasDedicatedCompute()) {
+    vkGetDeviceQueue(device_, indices.computeFamily, 0, &computeQueue_);
+    computeTimeline_ = std::make_unique<LvkTimeline>(device_, computeQueue_);
+  }
+  std::cout << "transfer queue: " << (indices.hasDedicatedTransfer() ? "dedicated" : "graphics")
+            << ", compute queue: " << (indices.hasDedicatedCompute() ? "dedicated" : "graphics") << std::endl;
+}
+
+void LvkDevice::createAllocator() {
+  allocator_ = std::make_unique<LvkAllocator>(physicalDevice, device_);
 }
 
 void LvkDevice::createCommandPool() {
@@ -185,23 +246,41 @@ void LvkDevice::createCommandPool() {
   VkCommandPoolCreateInfo poolInfo = {};
   poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily;
-  poolInfo.flags =
-      VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+  // recycled wholesale with vkResetCommandPool, so buffers need no individual reset
+  poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 
   if (vkCreateCommandPool(device_, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
     throw std::runtime_error("failed to create command pool!");
   }
+
+  VkCommandBufferAllocateInfo allocInfo{};
+  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.commandPool = commandPool;
+  allocInfo.commandBufferCount = 1;
+  if (vkAllocateCommandBuffers(device_, &allocInfo, &singleTimeCommandBuffer) != VK_SUCCESS) {
+    throw std::runtime_error("failed to allocate single time command buffer!");
+  }
+}
+
+void LvkDevice::createUploadQueue() { uploadQueue_ = std::make_unique<LvkUploadQueue>(*this); }
+
+void LvkDevice::createPipelineCache() {
+  pipelineCache_ = std::make_unique<LvkPipelineCache>(*this);
+  std::cout << "pipeline cache: " << (pipelineCache_->wasLoaded() ? "loaded from disk" : "empty") << std::endl;
 }
 
-void LvkDevice::createSurface() { window.createWindowSurface(instance, &surface_); }
+void LvkDevice::createPipelineRegistry() { pipelineRegistry_ = std::make_unique<LvkPipelineRegistry>(*this); }
+
+void LvkDevice::createSurface() { window->createWindowSurface(instance, &surface_); }
 
 bool LvkDevice::isDeviceSuitable(VkPhysicalDevice device) {
   QueueFamilyIndices indices = findQueueFamilies(device);
 
   bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-  bool swapChainAdequate = false;
-  if (extensionsSupported) {
+  bool swapChainAdequate = isHeadless();
+  if (extensionsSupported && !isHeadless()) {
     SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
     swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
   }
@@ -209,8 +288,22 @@ bool LvkDevice::isDeviceSuitable(VkPhysicalDevice device) {
   VkPhysicalDeviceFeatures supportedFeatures;
   vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+  // frame pacing, uploads and deferred destruction all run on timeline semaphores
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+  VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+  timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  VkPhysicalDeviceFeatures2 features2 = {};
+  features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features2.pNext = &timelineFeatures;
+  bool timelineSupported = false;
+  if (deviceProperties.apiVersion >= VK_API_VERSION_1_2) {
+    vkGetPhysicalDeviceFeatures2(device, &features2);
+    timelineSupported = timelineFeatures.timelineSemaphore == VK_TRUE;
+  }
+
   return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-         supportedFeatures.samplerAnisotropy;
+         supportedFeatures.samplerAnisotropy && timelineSupported;
 }
 
 void LvkDevice::populateDebugMessengerCreateInfo(
@@ -261,11 +354,13 @@ bool LvkDevice::checkValidationLayerSupport() {
 }
 
 std::vector<const char *> LvkDevice::getRequiredExtensions() {
-  uint32_t glfwExtensionCount = 0;
-  const char **glfwExtensions;
-  glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-  std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+  std::vector<const char *> extensions;
+  if (!isHeadless()) {
+    uint32_t glfwExtensionCount = 0;
+    const char **glfwExtensions;
+    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+  }
 
   if (enableValidationLayers) {
     extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -317,8 +412,18 @@ bool LvkDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
   return requiredExtensions.empty();
 }
 
+uint32_t LvkDevice::timestampValidBits(uint32_t queueFamily) {
+  uint32_t queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+  assert(queueFamily < queueFamilyCount && "Queue family out of range");
+  return queueFamilies[queueFamily].timestampValidBits;
+}
+
 QueueFamilyIndices LvkDevice::findQueueFamilies(VkPhysicalDevice device) {
   QueueFamilyIndices indices;
+  indices.presentRequired = !isHeadless();
 
   uint32_t queueFamilyCount = 0;
   vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
@@ -332,11 +437,13 @@ QueueFamilyIndices LvkDevice::findQueueFamilies(VkPhysicalDevice device) {
       indices.graphicsFamily = i;
       indices.graphicsFamilyHasValue = true;
     }
-    VkBool32 presentSupport = false;
-    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
-    if (queueFamily.queueCount > 0 && presentSupport) {
-      indices.presentFamily = i;
-      indices.presentFamilyHasValue = true;
+    if (!isHeadless()) {
+      VkBool32 presentSupport = false;
+      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+      if (queueFamily.queueCount > 0 && presentSupport) {
+        indices.presentFamily = i;
+        indices.presentFamilyHasValue = true;
+      }
     }
     if (indices.isComplete()) {
       break;
@@ -344,7 +451,32 @@ QueueFamilyIndices LvkDevice::findQueueFamilies(VkPhysicalDevice device) {
 
     i++;
   }
+  if (!indices.graphicsFamilyHasValue) {
+    return indices;
+  }
 
+  // Prefer a transfer-only family (the copy engine), then any non-graphics family that can copy.
+  // Compute takes any family without graphics.
+  indices.transferFamily = indices.graphicsFamily;
+  indices.computeFamily = indices.graphicsFamily;
+  int transferScore = 0;
+  int computeScore = 0;
+  for (uint32_t family = 0; family < queueFamilyCount; family++) {
+    const auto &properties = queueFamilies[family];
+    if (properties.queueCount == 0 || properties.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+      continue;
+    }
+    const bool compute = properties.queueFlags & VK_QUEUE_COMPUTE_BIT;
+    // every compute family can copy, whether or not it reports TRANSFER
+    if ((properties.queueFlags & VK_QUEUE_TRANSFER_BIT || compute) && transferScore < (compute ? 1 : 2)) {
+      indices.transferFamily = family;
+      transferScore = compute ? 1 : 2;
+    }
+    if (compute && computeScore < 1) {
+      indices.computeFamily = family;
+      computeScore = 1;
+    }
+  }
   return indices;
 }
 
@@ -408,7 +540,7 @@ void LvkDevice::createBuffer(
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) {
+    LvkAllocation &bufferAllocation) {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
@@ -422,52 +554,44 @@ void LvkDevice::createBuffer(
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+  bufferAllocation = allocator_->allocate(memRequirements, properties, true);
 
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate vertex buffer memory!");
+  if (vkBindBufferMemory(device_, buffer, bufferAllocation.memory, bufferAllocation.offset) != VK_SUCCESS) {
+    throw std::runtime_error("failed to bind vertex buffer memory!");
   }
-
-  vkBindBufferMemory(device_, buffer, bufferMemory, 0);
 }
 
-VkCommandBuffer LvkDevice::beginSingleTimeCommands() {
-  VkCommandBufferAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-  allocInfo.commandPool = commandPool;
-  allocInfo.commandBufferCount = 1;
-
-  VkCommandBuffer commandBuffer;
-  vkAllocateCommandBuffers(device_, &allocInfo, &commandBuffer);
+SingleTimeCommands LvkDevice::beginSingleTimeCommands() {
+  SingleTimeCommands commands{singleTimeCommandBuffer, std::unique_lock<std::mutex>{singleTimeMutex}};
+  // the previous submission was waited on in endSingleTimeCommands; this also discards a
+  // recording abandoned by a throw
+  vkResetCommandPool(device_, commandPool, 0);
 
   VkCommandBufferBeginInfo beginInfo{};
   beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
-  vkBeginCommandBuffer(commandBuffer, &beginInfo);
-  return commandBuffer;
+  vkBeginCommandBuffer(singleTimeCommandBuffer, &beginInfo);
+  return commands;
 }
 
-void LvkDevice::endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-  vkEndCommandBuffer(commandBuffer);
+void LvkDevice::endSingleTimeCommands(SingleTimeCommands commands) {
+  assert(commands.commandBuffer == singleTimeCommandBuffer && commands.lock.owns_lock() &&
+         "Not commands from beginSingleTimeCommands");
+  vkEndCommandBuffer(commands.commandBuffer);
 
   VkSubmitInfo submitInfo{};
   submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submitInfo.commandBufferCount = 1;
-  submitInfo.pCommandBuffers = &commandBuffer;
+  submitInfo.pCommandBuffers = &commands.commandBuffer;
 
-  vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-  vkQueueWaitIdle(graphicsQueue_);
-
-  vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+  // wait on this submission only, not on everything else in flight on the queue
+  graphicsTimeline_->wait(graphicsTimeline_->submit(submitInfo));
 }
 
 void LvkDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+  SingleTimeCommands commands = beginSingleTimeCommands();
+  VkCommandBuffer commandBuffer = commands.commandBuffer;
 
   VkBufferCopy copyRegion{};
   copyRegion.srcOffset = 0;  // Optional
@@ -475,12 +599,13 @@ void LvkDevice::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize
   copyRegion.size = size;
   vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
-  endSingleTimeCommands(commandBuffer);
+  endSingleTimeCommands(std::move(commands));
 }
 
 void LvkDevice::copyBufferToImage(
     VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount) {
-  VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+  SingleTimeCommands commands = beginSingleTimeCommands();
+  VkCommandBuffer commandBuffer = commands.commandBuffer;
 
   VkBufferImageCopy region{};
   region.bufferOffset = 0;
@@ -502,14 +627,14 @@ void LvkDevice::copyBufferToImage(
       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
       1,
       &region);
-  endSingleTimeCommands(commandBuffer);
+  endSingleTimeCommands(std::move(commands));
 }
 
 void LvkDevice::createImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) {
+    LvkAllocation &imageAllocation) {
   if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
@@ -517,16 +642,12 @@ void LvkDevice::createImageWithInfo(
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
-  }
+  imageAllocation = allocator_->allocate(
+      memRequirements,
+      properties,
+      imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
 
-  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+  if (vkBindImageMemory(device_, image, imageAllocation.memory, imageAllocation.offset) != VK_SUCCESS) {
     throw std::runtime_error("failed to bind image memory!");
   }
 }
@@ -1,11 +1,19 @@
 #pragma once
 
 #include "lvk_window.hpp"
+#include "lvk_allocator.hpp"
+#include "lvk_upload_queue.hpp"
+#include "lvk_pipeline_cache.hpp"
+#include "lvk_deletion_queue.hpp"
+#include "lvk_timeline.hpp"
 // std lib headers
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace lvk {
+class LvkPipelineRegistry;
 
 struct SwapChainSupportDetails {
   VkSurfaceCapabilitiesKHR capabilities;
@@ -16,9 +24,23 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  // families without graphics, preferred for uploads and async compute; the graphics family
+  // when the device has none
+  uint32_t transferFamily;
+  uint32_t computeFamily;
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
-  bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
+  bool presentRequired = true;
+  bool isComplete() { return graphicsFamilyHasValue && (presentFamilyHasValue || !presentRequired); }
+  bool hasDedicatedTransfer() const { return transferFamily != graphicsFamily; }
+  bool hasDedicatedCompute() const { return computeFamily != graphicsFamily; }
+};
+
+// Recording on the device's one single-time command buffer. Owns the lock serializing its users,
+// so the buffer is released on every path, including when recording throws.
+struct SingleTimeCommands {
+  VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+  std::unique_lock<std::mutex> lock;
 };
 
 class LvkDevice {
@@ -30,6 +52,8 @@ class LvkDevice {
 #endif
 
   LvkDevice(LvkWindow &window);
+  // Headless device: no surface, no present queue and no swapchain extension.
+  LvkDevice();
   ~LvkDevice();
 
   // Not copyable or movable
@@ -43,22 +67,42 @@ class LvkDevice {
   VkSurfaceKHR surface() { return surface_; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  // Submit to graphicsQueue() only through this; its values track the GPU's progress on the queue.
+  LvkTimeline &graphicsTimeline() { return *graphicsTimeline_; }
+  // Without a dedicated family these are the graphics queue and timeline.
+  VkQueue transferQueue() { return transferQueue_; }
+  VkQueue computeQueue() { return computeQueue_; }
+  LvkTimeline &transferTimeline() { return transferTimeline_ ? *transferTimeline_ : *graphicsTimeline_; }
+  LvkTimeline &computeTimeline() { return computeTimeline_ ? *computeTimeline_ : *graphicsTimeline_; }
+  LvkAllocator &allocator() { return *allocator_; }
+  LvkUploadQueue &uploadQueue() { return *uploadQueue_; }
+  // Pass pipelineCache().handle() to every vkCreate*Pipelines call.
+  LvkPipelineCache &pipelineCache() { return *pipelineCache_; }
+  LvkPipelineRegistry &pipelineRegistry() { return *pipelineRegistry_; }
+  // Destroy anything the GPU may still be using through here rather than directly.
+  LvkDeletionQueue &deletionQueue() { return *deletionQueue_; }
+  bool isHeadless() const { return window == nullptr; }
 
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
   QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
+  // Meaningful bits in timestamps written on queueFamily's queues; 0 when it has no timestamps.
+  uint32_t timestampValidBits(uint32_t queueFamily);
   VkFormat findSupportedFormat(
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
   // Buffer Helper Functions
+  // Memory comes from allocator(); release it with allocator().free() after destroying the buffer.
   void createBuffer(
       VkDeviceSize size,
       VkBufferUsageFlags usage,
       VkMemoryPropertyFlags properties,
       VkBuffer &buffer,
-      VkDeviceMemory &bufferMemory);
-  VkCommandBuffer beginSingleTimeCommands();
-  void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+      LvkAllocation &bufferAllocation);
+  // Reuses one command buffer, so calls are serialized: the returned commands hold a lock until
+  // they are ended or destroyed.
+  SingleTimeCommands beginSingleTimeCommands();
+  void endSingleTimeCommands(SingleTimeCommands commands);
   void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
   void copyBufferToImage(
       VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
@@ -67,7 +111,7 @@ class LvkDevice {
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
       VkImage &image,
-      VkDeviceMemory &imageMemory);
+      LvkAllocation &imageAllocation);
 
   VkPhysicalDeviceProperties properties;
 
@@ -77,7 +121,11 @@ class LvkDevice {
   void createSurface();
   void pickPhysicalDevice();
   void createLogicalDevice();
+  void createAllocator();
   void createCommandPool();
+  void createUploadQueue();
+  void createPipelineCache();
+  void createPipelineRegistry();
 
   // helper functions
   bool isDeviceSuitable(VkPhysicalDevice device);
@@ -92,16 +140,28 @@ class LvkDevice {
   VkInstance instance;
   VkDebugUtilsMessengerEXT debugMessenger;
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-  LvkWindow &window;
+  LvkWindow *window = nullptr;
   VkCommandPool commandPool;
+  VkCommandBuffer singleTimeCommandBuffer = VK_NULL_HANDLE;
+  std::mutex singleTimeMutex;
+  std::unique_ptr<LvkTimeline> graphicsTimeline_;
+  std::unique_ptr<LvkTimeline> transferTimeline_;
+  std::unique_ptr<LvkTimeline> computeTimeline_;
+  std::unique_ptr<LvkAllocator> allocator_;
+  std::unique_ptr<LvkDeletionQueue> deletionQueue_ = std::make_unique<LvkDeletionQueue>();
+  std::unique_ptr<LvkUploadQueue> uploadQueue_;
+  std::unique_ptr<LvkPipelineCache> pipelineCache_;
+  std::unique_ptr<LvkPipelineRegistry> pipelineRegistry_;
 
   VkDevice device_;
-  VkSurfaceKHR surface_;
+  VkSurfaceKHR surface_ = VK_NULL_HANDLE;
   VkQueue graphicsQueue_;
-  VkQueue presentQueue_;
+  VkQueue presentQueue_ = VK_NULL_HANDLE;
+  VkQueue transferQueue_ = VK_NULL_HANDLE;
+  VkQueue computeQueue_ = VK_NULL_HANDLE;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
-  const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 };
 
 }  // namespace lve
\ No newline at end of file
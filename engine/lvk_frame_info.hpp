@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+namespace lvk {
+    struct FrameInfo {
+        int frameIndex;
+        VkCommandBuffer commandBuffer;
+        // what secondary command buffers recorded for this frame inherit
+        VkRenderPass renderPass;
+        VkFramebuffer framebuffer;
+        VkExtent2D extent;
+    };
+}
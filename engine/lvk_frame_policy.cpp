@@ -0,0 +1,42 @@
+#include "lvk_frame_policy.hpp"
+
+//std
+#include <cstdlib>
+#include <stdexcept>
+
+namespace lvk {
+
+    LvkFramePolicy LvkFramePolicy::throughput() {
+        LvkFramePolicy policy{};
+        policy.name = "throughput";
+        policy.framesInFlight = 3;
+        policy.extraImages = 2;
+        policy.presentModes = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+        return policy;
+    }
+
+    LvkFramePolicy LvkFramePolicy::lowLatency() {
+        LvkFramePolicy policy{};
+        policy.name = "low-latency";
+        policy.framesInFlight = 1;
+        policy.extraImages = 0;
+        policy.presentModes = {};
+        policy.waitBeforeInput = true;
+        return policy;
+    }
+
+    LvkFramePolicy LvkFramePolicy::fromName(const std::string &name) {
+        if (name == "balanced") return balanced();
+        if (name == "throughput") return throughput();
+        if (name == "low-latency") return lowLatency();
+        throw std::runtime_error("unknown frame policy: " + name);
+    }
+
+    LvkFramePolicy LvkFramePolicy::fromEnv() {
+        const char *name = std::getenv(ENV);
+        if (name == nullptr || *name == '\0') {
+            return balanced();
+        }
+        return fromName(name);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lvk {
+    // How far the CPU may run ahead of the display, traded between throughput and latency.
+    // LvkRenderer sizes its command buffers, the swap chain its sync objects and image count, from
+    // this. Pick one per deployment with the LVK_FRAME_POLICY environment variable.
+    struct LvkFramePolicy {
+        static constexpr const char *ENV = "LVK_FRAME_POLICY";
+        // most frames in flight any policy may ask for
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+        const char *name = "balanced";
+        uint32_t framesInFlight = 2;
+        // swap chain images requested beyond the surface's minimum
+        uint32_t extraImages = 1;
+        // in order of preference; FIFO is always the fallback, as it is the only mode guaranteed
+        std::vector<VkPresentModeKHR> presentModes{VK_PRESENT_MODE_MAILBOX_KHR};
+        // Wait for the previous frame to finish on the GPU before sampling input, so input is read
+        // as late as possible instead of queueing behind frames already in flight.
+        bool waitBeforeInput = false;
+
+        // 2 frames in flight, MAILBOX when available.
+        static LvkFramePolicy balanced() { return {}; }
+        // 3 frames in flight and the least blocking present mode, for the highest frame rate.
+        static LvkFramePolicy throughput();
+        // 1 frame in flight on FIFO, waiting for the GPU before input, for the shortest
+        // input-to-photon latency.
+        static LvkFramePolicy lowLatency();
+        // "balanced", "throughput" or "low-latency"; throws for anything else.
+        static LvkFramePolicy fromName(const std::string &name);
+        // The policy named by ENV, or balanced() if it is not set.
+        static LvkFramePolicy fromEnv();
+    };
+}
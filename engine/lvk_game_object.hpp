@@ -27,8 +27,13 @@ namespace lvk {
         using id_t = unsigned int;
 
     static LvkGameObject createGameObject(){
+        return LvkGameObject{allocateId()};
+    }
+
+    // Shared with LvkGameObjectStore so ids stay unique across both.
+    static id_t allocateId(){
         static id_t currentId = 0;
-        return LvkGameObject{currentId++};
+        return currentId++;
     }
 
     id_t getId() { return id; }
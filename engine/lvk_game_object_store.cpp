@@ -0,0 +1,84 @@
+#include "lvk_game_object_store.hpp"
+#include "lvk_transform_kernel.hpp"
+
+// std
+#include <cassert>
+
+namespace lvk {
+
+    LvkGameObjectStore::ModelHandle LvkGameObjectStore::registerModel(std::shared_ptr<LvkModel> model) {
+        auto [it, inserted] = modelHandles.try_emplace(model.get(), static_cast<ModelHandle>(modelTable.size()));
+        if (inserted) {
+            modelTable.push_back(std::move(model));
+        }
+        return it->second;
+    }
+
+    LvkGameObjectStore::id_t LvkGameObjectStore::create(
+            ModelHandle model, const glm::vec3 &color, const Transform2dComponent &transform) {
+        assert(model < modelTable.size() && "Model handle was not registered with this store");
+        id_t id = LvkGameObject::allocateId();
+        if (id >= sparse.size()) {
+            sparse.resize(static_cast<size_t>(id) + 1, INVALID_INDEX);
+        }
+        sparse[id] = size();
+
+        ids.push_back(id);
+        translations.push_back(transform.translation);
+        scales.push_back(transform.scale);
+        rotations.push_back(transform.rotation);
+        colors.push_back(color);
+        models.push_back(model);
+        transforms.emplace_back(0.f, 0.f, 0.f, 0.f);
+        dirty.push_back(1);
+        return id;
+    }
+
+    void LvkGameObjectStore::destroy(id_t id) {
+        uint32_t index = indexOf(id);
+        assert(index != INVALID_INDEX && "Destroying an object that is not in this store");
+        uint32_t last = size() - 1;
+        if (index != last) {
+            ids[index] = ids[last];
+            translations[index] = translations[last];
+            scales[index] = scales[last];
+            rotations[index] = rotations[last];
+            colors[index] = colors[last];
+            models[index] = models[last];
+            transforms[index] = transforms[last];
+            dirty[index] = dirty[last];
+            sparse[ids[index]] = index;
+        }
+        ids.pop_back();
+        translations.pop_back();
+        scales.pop_back();
+        rotations.pop_back();
+        colors.pop_back();
+        models.pop_back();
+        transforms.pop_back();
+        dirty.pop_back();
+        sparse[id] = INVALID_INDEX;
+    }
+
+    void LvkGameObjectStore::reserve(uint32_t count) {
+        ids.reserve(count);
+        translations.reserve(count);
+        scales.reserve(count);
+        rotations.reserve(count);
+        colors.reserve(count);
+        models.reserve(count);
+        transforms.reserve(count);
+        dirty.reserve(count);
+    }
+
+    void LvkGameObjectStore::updateTransforms() {
+        static_assert(sizeof(glm::vec2) == 2 * sizeof(float) && sizeof(glm::vec4) == 4 * sizeof(float),
+                      "the transform kernel reads and writes tightly packed floats");
+        computeTransforms2d(
+                reinterpret_cast<const float *>(scales.data()),
+                rotations.data(),
+                dirty.data(),
+                reinterpret_cast<float *>(transforms.data()),
+                size());
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lvk_game_object.hpp"
+#include "lvk_model.hpp"
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk {
+
+    // Structure-of-arrays storage for game objects. Each component lives in its own dense array,
+    // indexed 0..size()-1 with no holes, so systems can stream through exactly the components they
+    // touch. Objects keep the id_t handed out by LvkGameObject; a sparse id -> index table finds
+    // them, and destroy() swap-removes so the arrays stay packed (dense order is not stable).
+    class LvkGameObjectStore {
+    public:
+        using id_t = LvkGameObject::id_t;
+        using ModelHandle = uint32_t;
+
+        static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+
+        // Models are referenced by handle so the per-object array is 4 bytes instead of a shared_ptr.
+        ModelHandle registerModel(std::shared_ptr<LvkModel> model);
+        LvkModel &model(ModelHandle handle) const { return *modelTable[handle]; }
+        uint32_t modelCount() const { return static_cast<uint32_t>(modelTable.size()); }
+
+        id_t create(ModelHandle model, const glm::vec3 &color, const Transform2dComponent &transform);
+        void destroy(id_t id);
+        bool contains(id_t id) const { return indexOf(id) != INVALID_INDEX; }
+        uint32_t indexOf(id_t id) const { return id < sparse.size() ? sparse[id] : INVALID_INDEX; }
+
+        uint32_t size() const { return static_cast<uint32_t>(ids.size()); }
+        void reserve(uint32_t count);
+
+        // Call after writing scales or rotations directly so updateTransforms() picks the object up.
+        void markDirty(uint32_t index) { dirty[index] = 1; }
+        void markAllDirty() { std::fill(dirty.begin(), dirty.end(), uint8_t{1}); }
+        // Recomputes transforms[] for dirty objects with the SIMD kernel and clears their flags.
+        void updateTransforms();
+
+        // dense component arrays, all size() long
+        std::vector<id_t> ids;
+        std::vector<glm::vec2> translations;
+        std::vector<glm::vec2> scales;
+        std::vector<float> rotations;
+        std::vector<glm::vec3> colors;
+        std::vector<ModelHandle> models;
+        // rotation * scale packed as the matrix columns (c*sx, s*sx, -s*sy, c*sy), see updateTransforms()
+        std::vector<glm::vec4> transforms;
+        std::vector<uint8_t> dirty;
+
+    private:
+        std::vector<uint32_t> sparse;
+        std::vector<std::shared_ptr<LvkModel>> modelTable;
+        std::unordered_map<const LvkModel *, ModelHandle> modelHandles;
+    };
+}
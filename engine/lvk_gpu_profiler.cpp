@@ -0,0 +1,144 @@
+#include "lvk_gpu_profiler.hpp"
+#include "lvk_device.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <string_view>
+
+namespace lvk {
+
+    LvkGpuProfiler::LvkGpuProfiler(
+            LvkDevice &device,
+            uint32_t queueFamily,
+            const char *trackName,
+            uint32_t slotCount,
+            uint32_t maxScopesPerSlot)
+            : lvkDevice{device},
+              trackName{trackName},
+              maxScopes{maxScopesPerSlot},
+              nsPerTick{static_cast<double>(device.properties.limits.timestampPeriod)},
+              slots(slotCount) {
+        assert(slotCount > 0 && maxScopesPerSlot > 0 && "GPU profiler needs at least one slot and scope");
+        // per family: timestampComputeAndGraphics says nothing about transfer-only queues
+        const uint32_t validBits = device.timestampValidBits(queueFamily);
+        if (validBits == 0 || nsPerTick <= 0.0) {
+            return;
+        }
+        timestampMask = validBits >= 64 ? std::numeric_limits<uint64_t>::max() : (1ull << validBits) - 1;
+        VkQueryPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        poolInfo.queryCount = slotCount * maxScopes * 2;
+        if (vkCreateQueryPool(lvkDevice.device(), &poolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+        for (auto &slot : slots) {
+            slot.names.reserve(maxScopes);
+        }
+        readback.resize(static_cast<size_t>(maxScopes) * 2);
+    }
+
+    LvkGpuProfiler::~LvkGpuProfiler() {
+        if (queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(lvkDevice.device(), queryPool, nullptr);
+        }
+    }
+
+    void LvkGpuProfiler::beginSlot(VkCommandBuffer commandBuffer, uint32_t slot) {
+        if (!isSupported()) return;
+        assert(slot < slots.size() && "GPU profiler slot out of range");
+        assert(slots[currentSlot].openScopes == 0 && "GPU scope left open across slots");
+        collect(slot);
+        currentSlot = slot;
+        slots[slot].names.clear();
+        slots[slot].recorded = true;
+        vkCmdResetQueryPool(commandBuffer, queryPool, queryIndex(slot, 0, 0), maxScopes * 2);
+    }
+
+    uint32_t LvkGpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char *name) {
+        if (!isSupported()) return INVALID_SCOPE;
+        Slot &slot = slots[currentSlot];
+        if (!slot.recorded || slot.names.size() == maxScopes) {
+            return INVALID_SCOPE;
+        }
+        const auto scope = static_cast<uint32_t>(slot.names.size());
+        slot.names.push_back(name);
+        slot.openScopes++;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, queryIndex(currentSlot, scope, 0));
+        return scope;
+    }
+
+    void LvkGpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+        if (scope == INVALID_SCOPE) return;
+        slots[currentSlot].openScopes--;
+        vkCmdWriteTimestamp(
+                commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, queryIndex(currentSlot, scope, 1));
+    }
+
+    double LvkGpuProfiler::latestMs(const char *name) const {
+        for (const auto &result : latest) {
+            if (std::string_view{result.name} == name) {
+                return result.durationMs();
+            }
+        }
+        return 0.0;
+    }
+
+    void LvkGpuProfiler::collect(uint32_t slotIndex) {
+        Slot &slot = slots[slotIndex];
+        if (!slot.recorded || slot.names.empty()) {
+            return;
+        }
+        const auto queryCount = static_cast<uint32_t>(slot.names.size() * 2);
+        // no WAIT_BIT: the caller guarantees the slot's work is done, so this never stalls
+        VkResult result = vkGetQueryPoolResults(
+                lvkDevice.device(),
+                queryPool,
+                queryIndex(slotIndex, 0, 0),
+                queryCount,
+                queryCount * sizeof(uint64_t),
+                readback.data(),
+                sizeof(uint64_t),
+                VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS) {
+            return;
+        }
+        latest.clear();
+        for (size_t i = 0; i < slot.names.size(); i++) {
+            const uint64_t beginTicks = readback[i * 2] & timestampMask;
+            // modulo the valid bits, so a counter that wrapped inside the scope still gives its length
+            const uint64_t ticks = (readback[i * 2 + 1] - beginTicks) & timestampMask;
+            auto beginNs = static_cast<uint64_t>(static_cast<double>(beginTicks) * nsPerTick);
+            auto endNs = beginNs + static_cast<uint64_t>(static_cast<double>(ticks) * nsPerTick);
+            latest.push_back({slot.names[i], beginNs, endNs});
+        }
+        if (captureTrace) {
+            traceEvents.insert(traceEvents.end(), latest.begin(), latest.end());
+        }
+    }
+
+    void LvkGpuProfiler::writeChromeTrace(std::ostream &out, std::initializer_list<const LvkGpuProfiler *> profilers) {
+        // all profilers read the same device clock, so their scopes share one timeline
+        uint64_t originNs = std::numeric_limits<uint64_t>::max();
+        for (const auto *profiler : profilers) {
+            for (const auto &event : profiler->traceEvents) {
+                originNs = std::min(originNs, event.beginNs);
+            }
+        }
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        for (const auto *profiler : profilers) {
+            for (const auto &event : profiler->traceEvents) {
+                out << (first ? "  " : ",\n  ");
+                first = false;
+                out << "{\"name\": \"" << event.name << "\", \"cat\": \"gpu\", \"ph\": \"X\", \"pid\": 1"
+                    << ", \"tid\": \"" << profiler->trackName << "\""
+                    << ", \"ts\": " << static_cast<double>(event.beginNs - originNs) * 1e-3
+                    << ", \"dur\": " << static_cast<double>(event.endNs - event.beginNs) * 1e-3 << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+namespace lvk {
+    class LvkDevice;
+
+    // Measures GPU time of named scopes with timestamp queries. Queries are split into slots, one
+    // per unit of work that is recycled once complete (a frame in flight, an upload batch). When
+    // a slot is begun again its previous work has finished, so the results are read back
+    // without waiting and the queries are reset for reuse.
+    class LvkGpuProfiler {
+    public:
+        struct ScopeResult {
+            const char *name;
+            uint64_t beginNs;
+            uint64_t endNs;
+
+            double durationMs() const { return static_cast<double>(endNs - beginNs) * 1e-6; }
+        };
+
+        static constexpr uint32_t INVALID_SCOPE = std::numeric_limits<uint32_t>::max();
+
+        // queueFamily is the family of the queue the slots' work is submitted to. trackName labels
+        // this profiler's scopes in the Chrome trace. Scope names must outlive the profiler;
+        // string literals are the intended use.
+        LvkGpuProfiler(
+                LvkDevice &device,
+                uint32_t queueFamily,
+                const char *trackName,
+                uint32_t slotCount,
+                uint32_t maxScopesPerSlot = 64);
+        ~LvkGpuProfiler();
+
+        LvkGpuProfiler(const LvkGpuProfiler &) = delete;
+        LvkGpuProfiler &operator=(const LvkGpuProfiler &) = delete;
+
+        // False when the queue cannot write timestamps; every call is then a no-op.
+        bool isSupported() const { return queryPool != VK_NULL_HANDLE; }
+
+        // Must be recorded outside a render pass, once the slot's previous work has completed.
+        void beginSlot(VkCommandBuffer commandBuffer, uint32_t slot);
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+        // Scopes of the most recently read back slot, in the order they were begun.
+        const std::vector<ScopeResult> &latestResults() const { return latest; }
+        double latestMs(const char *name) const;
+
+        // While enabled, every result read back is also kept for writeChromeTrace.
+        void setTraceCapture(bool enabled) { captureTrace = enabled; }
+        static void writeChromeTrace(std::ostream &out, std::initializer_list<const LvkGpuProfiler *> profilers);
+
+    private:
+        struct Slot {
+            std::vector<const char *> names;
+            uint32_t openScopes = 0;
+            bool recorded = false;
+        };
+
+        uint32_t queryIndex(uint32_t slot, uint32_t scope, uint32_t edge) const {
+            return (slot * maxScopes + scope) * 2 + edge;
+        }
+        void collect(uint32_t slot);
+
+        LvkDevice &lvkDevice;
+        const char *trackName;
+        uint32_t maxScopes;
+        double nsPerTick;
+        // bits of a raw timestamp the queue actually writes; the rest are undefined
+        uint64_t timestampMask = 0;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+
+        std::vector<Slot> slots;
+        uint32_t currentSlot = 0;
+        std::vector<uint64_t> readback;
+        std::vector<ScopeResult> latest;
+        bool captureTrace = false;
+        std::vector<ScopeResult> traceEvents;
+    };
+
+    // Times the enclosing C++ scope on the GPU.
+    class LvkGpuScope {
+    public:
+        LvkGpuScope(LvkGpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name)
+                : profiler{profiler}, commandBuffer{commandBuffer}, scope{profiler.beginScope(commandBuffer, name)} {}
+        ~LvkGpuScope() { profiler.endScope(commandBuffer, scope); }
+
+        LvkGpuScope(const LvkGpuScope &) = delete;
+        LvkGpuScope &operator=(const LvkGpuScope &) = delete;
+
+    private:
+        LvkGpuProfiler &profiler;
+        VkCommandBuffer commandBuffer;
+        uint32_t scope;
+    };
+}
+
+#define LVK_GPU_SCOPE_CONCAT_IMPL(a, b) a##b
+#define LVK_GPU_SCOPE_CONCAT(a, b) LVK_GPU_SCOPE_CONCAT_IMPL(a, b)
+#define LVK_GPU_SCOPE(profiler, commandBuffer, name) \
+    ::lvk::LvkGpuScope LVK_GPU_SCOPE_CONCAT(lvkGpuScope, __LINE__){profiler, commandBuffer, name}
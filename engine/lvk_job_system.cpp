@@ -0,0 +1,177 @@
+#include "lvk_job_system.hpp"
+#include "lvk_trace.hpp"
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+namespace lvk {
+
+    namespace {
+        struct ThreadSlot {
+            const LvkJobSystem *owner = nullptr;
+            uint32_t index = 0;
+        };
+        thread_local ThreadSlot currentThread{};
+
+        constexpr uint32_t NO_HOME = UINT32_MAX;
+    }
+
+    LvkJobSystem::LvkJobSystem(uint32_t workerCount) {
+        if (workerCount == 0) {
+            uint32_t hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = std::max<uint32_t>(hardwareThreads, 2) - 1;
+        }
+        workers.reserve(workerCount);
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        // start threads only after the worker array is complete, since they steal from each other
+        for (uint32_t i = 0; i < workerCount; i++) {
+            workers[i]->thread = std::thread{&LvkJobSystem::workerLoop, this, i};
+        }
+    }
+
+    LvkJobSystem::~LvkJobSystem() {
+        {
+            std::lock_guard<std::mutex> lock{sleepMutex};
+            stopping = true;
+        }
+        wakeCondition.notify_all();
+        for (auto &worker : workers) {
+            worker->thread.join();
+        }
+    }
+
+    uint32_t LvkJobSystem::threadIndex() {
+        return currentThread.index;
+    }
+
+    bool LvkJobSystem::ownsCurrentThread() const {
+        return currentThread.owner == this;
+    }
+
+    bool LvkJobSystem::onWorkerThread() {
+        return currentThread.owner != nullptr;
+    }
+
+    void LvkJobSystem::submit(Job job, Counter *counter) {
+        if (counter != nullptr) {
+            counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+        // jobs spawned by a worker stay on its own deque (cache-warm, stolen only if others idle)
+        uint32_t target = currentThread.owner == this
+                          ? currentThread.index - 1
+                          : nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount();
+        {
+            std::lock_guard<std::mutex> lock{workers[target]->mutex};
+            workers[target]->tasks.push_back(Task{std::move(job), counter});
+        }
+        queuedTasks.fetch_add(1, std::memory_order_release);
+        {
+            // pairs with the predicate check in workerLoop so the wake-up cannot be lost
+            std::lock_guard<std::mutex> lock{sleepMutex};
+        }
+        wakeCondition.notify_one();
+    }
+
+    void LvkJobSystem::wait(Counter &counter) {
+        uint32_t home = currentThread.owner == this ? currentThread.index - 1 : NO_HOME;
+        while (!counter.isDone()) {
+            if (!tryRunOne(home)) {
+                std::this_thread::yield();
+            }
+        }
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock{counter.errorMutex};
+            std::swap(error, counter.error);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void LvkJobSystem::parallelFor(
+            uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)> &fn) {
+        assert(grainSize > 0 && "grainSize must be non-zero");
+        Counter counter{};
+        for (uint32_t begin = 0; begin < count; begin += grainSize) {
+            uint32_t end = std::min(count, begin + grainSize);
+            submit([&fn, begin, end] { fn(begin, end); }, &counter);
+        }
+        wait(counter);
+    }
+
+    void LvkJobSystem::workerLoop(uint32_t index) {
+        currentThread = ThreadSlot{this, index + 1};
+        LVK_TRACE_THREAD_NAME(("worker " + std::to_string(index + 1)).c_str());
+        while (true) {
+            if (tryRunOne(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock{sleepMutex};
+            wakeCondition.wait(lock, [this] {
+                return stopping || queuedTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping && queuedTasks.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    bool LvkJobSystem::tryRunOne(uint32_t home) {
+        Task task;
+        if ((home != NO_HOME && popLocal(home, task)) || steal(home, task)) {
+            run(task);
+            return true;
+        }
+        return false;
+    }
+
+    bool LvkJobSystem::popLocal(uint32_t index, Task &task) {
+        Worker &worker = *workers[index];
+        std::lock_guard<std::mutex> lock{worker.mutex};
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool LvkJobSystem::steal(uint32_t thief, Task &task) {
+        const uint32_t count = workerCount();
+        const uint32_t start = thief == NO_HOME ? 0 : thief + 1;
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t victim = (start + i) % count;
+            if (victim == thief) continue;
+            Worker &worker = *workers[victim];
+            std::lock_guard<std::mutex> lock{worker.mutex};
+            if (worker.tasks.empty()) continue;
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void LvkJobSystem::run(Task &task) {
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        LVK_TRACE_ZONE("job");
+        try {
+            task.job();
+        } catch (...) {
+            if (task.counter != nullptr) {
+                std::lock_guard<std::mutex> lock{task.counter->errorMutex};
+                if (!task.counter->error) {
+                    task.counter->error = std::current_exception();
+                }
+            }
+        }
+        if (task.counter != nullptr) {
+            task.counter->pending.fetch_sub(1, std::memory_order_release);
+        }
+    }
+}
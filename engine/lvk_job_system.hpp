@@ -0,0 +1,80 @@
+#pragma once
+
+//std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lvk {
+
+    // Fixed pool of worker threads, each with its own deque. Workers pop their own newest job and,
+    // when that runs dry, steal the oldest job of another worker. Threads that wait on a counter
+    // run jobs themselves instead of blocking, so nested waits cannot deadlock the pool.
+    class LvkJobSystem {
+    public:
+        using Job = std::function<void()>;
+
+        // Tracks a group of jobs. The first exception thrown by one of them is rethrown by wait().
+        class Counter {
+        public:
+            bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+        private:
+            friend class LvkJobSystem;
+            std::atomic<uint32_t> pending{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+        };
+
+        // workerCount 0 means one worker per hardware thread, minus the calling thread.
+        explicit LvkJobSystem(uint32_t workerCount = 0);
+        ~LvkJobSystem();
+
+        LvkJobSystem(const LvkJobSystem &) = delete;
+        LvkJobSystem &operator=(const LvkJobSystem &) = delete;
+
+        void submit(Job job, Counter *counter = nullptr);
+        void wait(Counter &counter);
+        // Splits [0, count) into chunks of grainSize and blocks until fn has run on all of them.
+        void parallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t begin, uint32_t end)> &fn);
+
+        uint32_t workerCount() const { return static_cast<uint32_t>(workers.size()); }
+        // 0 on threads outside the pool, 1..workerCount() on workers.
+        static uint32_t threadIndex();
+        // Whether the calling thread is one of this pool's workers, or of any pool's.
+        bool ownsCurrentThread() const;
+        static bool onWorkerThread();
+
+    private:
+        struct Task {
+            Job job;
+            Counter *counter = nullptr;
+        };
+
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        void workerLoop(uint32_t index);
+        bool tryRunOne(uint32_t home);
+        bool popLocal(uint32_t index, Task &task);
+        bool steal(uint32_t thief, Task &task);
+        void run(Task &task);
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<uint32_t> nextWorker{0};
+        std::atomic<uint32_t> queuedTasks{0};
+        std::mutex sleepMutex;
+        std::condition_variable wakeCondition;
+        bool stopping = false;
+    };
+}
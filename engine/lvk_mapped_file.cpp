@@ -0,0 +1,61 @@
+#include "lvk_mapped_file.hpp"
+
+//std
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lvk {
+
+#ifdef _WIN32
+    LvkMappedFile::LvkMappedFile(const std::string &filepath) {
+        std::ifstream file{filepath, std::ios::ate | std::ios::binary};
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to open file: " + filepath);
+        }
+        size_ = static_cast<size_t>(file.tellg());
+        contents.resize(size_);
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(contents.data()), static_cast<std::streamsize>(size_));
+        data_ = contents.data();
+    }
+
+    LvkMappedFile::~LvkMappedFile() = default;
+#else
+    LvkMappedFile::LvkMappedFile(const std::string &filepath) {
+        int fd = open(filepath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open file: " + filepath);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("failed to stat file: " + filepath);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            void *mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("failed to map file: " + filepath);
+            }
+            data_ = static_cast<const std::byte *>(mapping);
+        }
+        // the mapping keeps its own reference to the file
+        close(fd);
+    }
+
+    LvkMappedFile::~LvkMappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<std::byte *>(data_), size_);
+        }
+    }
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+//std
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lvk {
+
+    // Read-only view of a whole file. On POSIX the file is mmap'ed, so pages are only faulted in
+    // as they are touched; elsewhere the contents are read into memory up front.
+    class LvkMappedFile {
+    public:
+        explicit LvkMappedFile(const std::string &filepath);
+        ~LvkMappedFile();
+
+        LvkMappedFile(const LvkMappedFile &) = delete;
+        LvkMappedFile &operator=(const LvkMappedFile &) = delete;
+
+        const std::byte *data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const std::byte *data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        std::vector<std::byte> contents;
+#endif
+    };
+}
@@ -0,0 +1,158 @@
+#include "lvk_mesh_cache.hpp"
+#include "lvk_utils.hpp"
+
+//std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace lvk {
+
+    namespace {
+        constexpr char MESH_CACHE_MAGIC[8] = {'L', 'V', 'K', 'M', 'E', 'S', 'H', '\0'};
+        constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+        struct MeshCacheHeader {
+            char magic[8];
+            uint32_t version;
+            uint32_t vertexStride;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t indexSize;
+            uint32_t reserved;
+            uint64_t sourceSize;
+            int64_t sourceMtime;
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+        };
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        template <typename Index>
+        bool indicesInRange(const std::byte *indices, uint32_t indexCount, uint32_t vertexCount) {
+            const auto *typed = reinterpret_cast<const Index *>(indices);
+            for (uint32_t i = 0; i < indexCount; i++) {
+                if (typed[i] >= vertexCount) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool sourceStamp(const std::string &sourcePath, uint64_t &size, int64_t &mtime) {
+            std::error_code ec;
+            auto fileSize = std::filesystem::file_size(sourcePath, ec);
+            if (ec) return false;
+            auto writeTime = std::filesystem::last_write_time(sourcePath, ec);
+            if (ec) return false;
+            size = static_cast<uint64_t>(fileSize);
+            mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+            return true;
+        }
+    }
+
+    LvkMeshCache::LvkMeshCache(std::unique_ptr<LvkMappedFile> file) : file{std::move(file)} {}
+
+    std::unique_ptr<LvkMeshCache> LvkMeshCache::open(const std::string &cachePath, const std::string &sourcePath) {
+        uint64_t sourceSize = 0;
+        int64_t sourceMtime = 0;
+        if (!std::filesystem::exists(cachePath) || !sourceStamp(sourcePath, sourceSize, sourceMtime)) {
+            return nullptr;
+        }
+
+        // unreadable (permissions, or the writer renaming it right now) is just another miss
+        std::unique_ptr<LvkMappedFile> mapped;
+        try {
+            mapped = std::make_unique<LvkMappedFile>(cachePath);
+        } catch (const std::runtime_error &) {
+            return nullptr;
+        }
+        if (mapped->size() < sizeof(MeshCacheHeader)) {
+            return nullptr;
+        }
+        MeshCacheHeader header;
+        memcpy(&header, mapped->data(), sizeof(header));
+        if (memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 ||
+            header.version != VERSION ||
+            header.vertexStride != sizeof(LvkModel::Vertex) ||
+            header.sourceSize != sourceSize ||
+            header.sourceMtime != sourceMtime ||
+            header.vertexCount == 0) {
+            return nullptr;
+        }
+        if (header.indexCount > 0 && header.indexSize != sizeof(uint16_t) && header.indexSize != sizeof(uint32_t)) {
+            return nullptr;
+        }
+        const uint64_t vertexBytes = uint64_t{header.vertexStride} * header.vertexCount;
+        const uint64_t indexBytes = uint64_t{header.indexSize} * header.indexCount;
+        // written so a huge offset cannot wrap the sum back into range
+        const uint64_t fileSize = mapped->size();
+        if (header.vertexOffset % BLOB_ALIGNMENT != 0 || header.indexOffset % BLOB_ALIGNMENT != 0 ||
+            header.vertexOffset > fileSize || vertexBytes > fileSize - header.vertexOffset ||
+            header.indexOffset > fileSize || indexBytes > fileSize - header.indexOffset) {
+            return nullptr;
+        }
+
+        // a stale or corrupt index would have the GPU read past the vertex buffer
+        const std::byte *indices = mapped->data() + header.indexOffset;
+        const bool indicesValid = header.indexSize == sizeof(uint16_t)
+                                  ? indicesInRange<uint16_t>(indices, header.indexCount, header.vertexCount)
+                                  : indicesInRange<uint32_t>(indices, header.indexCount, header.vertexCount);
+        if (!indicesValid) {
+            return nullptr;
+        }
+
+        std::unique_ptr<LvkMeshCache> cache{new LvkMeshCache(std::move(mapped))};
+        const std::byte *base = cache->file->data();
+        cache->data.vertices = reinterpret_cast<const LvkModel::Vertex *>(base + header.vertexOffset);
+        cache->data.vertexCount = header.vertexCount;
+        cache->data.indices = header.indexCount > 0 ? base + header.indexOffset : nullptr;
+        cache->data.indexCount = header.indexCount;
+        cache->data.indexType = header.indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        return cache;
+    }
+
+    void LvkMeshCache::write(const std::string &cachePath, const std::string &sourcePath, const LvkModel::MeshData &mesh) {
+        MeshCacheHeader header{};
+        memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+        header.version = VERSION;
+        header.vertexStride = sizeof(LvkModel::Vertex);
+        header.vertexCount = mesh.vertexCount;
+        header.indexCount = mesh.indexCount;
+        header.indexSize = mesh.indexCount == 0 ? 0
+                           : mesh.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        if (!sourceStamp(sourcePath, header.sourceSize, header.sourceMtime)) {
+            throw std::runtime_error("failed to stat mesh source: " + sourcePath);
+        }
+
+        const uint64_t vertexBytes = uint64_t{header.vertexStride} * header.vertexCount;
+        const uint64_t indexBytes = uint64_t{header.indexSize} * header.indexCount;
+        header.vertexOffset = alignUp(sizeof(MeshCacheHeader), BLOB_ALIGNMENT);
+        header.indexOffset = alignUp(header.vertexOffset + vertexBytes, BLOB_ALIGNMENT);
+
+        const std::string tmpPath = uniqueTempPath(cachePath);
+        {
+            std::ofstream out{tmpPath, std::ios::binary | std::ios::trunc};
+            if (!out.is_open()) {
+                throw std::runtime_error("failed to open mesh cache for writing: " + tmpPath);
+            }
+            const char zeros[BLOB_ALIGNMENT] = {};
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(zeros, static_cast<std::streamsize>(header.vertexOffset - sizeof(header)));
+            out.write(reinterpret_cast<const char *>(mesh.vertices), static_cast<std::streamsize>(vertexBytes));
+            out.write(zeros, static_cast<std::streamsize>(header.indexOffset - header.vertexOffset - vertexBytes));
+            out.write(static_cast<const char *>(mesh.indices), static_cast<std::streamsize>(indexBytes));
+            if (!out) {
+                out.close();
+                // the name is unique, so nothing else would ever overwrite it
+                std::error_code ec;
+                std::filesystem::remove(tmpPath, ec);
+                throw std::runtime_error("failed to write mesh cache: " + tmpPath);
+            }
+        }
+        std::filesystem::rename(tmpPath, cachePath);
+    }
+}
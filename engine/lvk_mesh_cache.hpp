@@ -0,0 +1,35 @@
+#pragma once
+
+#include "lvk_mapped_file.hpp"
+#include "lvk_model.hpp"
+
+//std
+#include <memory>
+#include <string>
+
+namespace lvk {
+
+    // Binary, load-ready copy of a mesh file: a fixed header followed by the vertex and index blobs
+    // in exactly the layout LvkModel uploads, so a warm load is an mmap plus a copy into staging.
+    // The format is native-endian and tied to sizeof(LvkModel::Vertex); anything that does not
+    // match is treated as a cache miss and rebuilt from the source file.
+    class LvkMeshCache {
+    public:
+        static constexpr uint32_t VERSION = 1;
+
+        // Returns nullptr when the cache is missing, unreadable, malformed (including an empty mesh or
+        // indices past vertexCount) or does not match the source's size and mtime.
+        static std::unique_ptr<LvkMeshCache> open(const std::string &cachePath, const std::string &sourcePath);
+        // Writes to a temporary file first and renames it over cachePath, so readers never see a partial file.
+        static void write(const std::string &cachePath, const std::string &sourcePath, const LvkModel::MeshData &mesh);
+
+        // Points into the mapping; only valid while this cache object is alive.
+        LvkModel::MeshData meshData() const { return data; }
+
+    private:
+        explicit LvkMeshCache(std::unique_ptr<LvkMappedFile> file);
+
+        std::unique_ptr<LvkMappedFile> file;
+        LvkModel::MeshData data{};
+    };
+}
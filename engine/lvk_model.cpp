@@ -1,42 +1,278 @@
 #include "lvk_model.hpp"
+#include "lvk_mesh_cache.hpp"
+#include "lvk_utils.hpp"
 
-#include <cstring>
+#include <tiny_obj_loader.h>
+#define CGLTF_IMPLEMENTATION
+#include <cgltf.h>
+
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace std {
+    template <>
+    struct hash<lvk::LvkModel::Vertex> {
+        size_t operator()(const lvk::LvkModel::Vertex &vertex) const {
+            size_t seed = 0;
+            lvk::hashCombine(seed, vertex.position.x, vertex.position.y,
+                             vertex.color.x, vertex.color.y, vertex.color.z);
+            return seed;
+        }
+    };
+}
+
 namespace lvk {
 
+    namespace {
+        class VertexDeduplicator {
+        public:
+            explicit VertexDeduplicator(LvkModel::Builder &builder) : builder{builder} {}
+
+            void add(const LvkModel::Vertex &vertex) {
+                auto [it, inserted] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(builder.vertices.size()));
+                if (inserted) {
+                    builder.vertices.push_back(vertex);
+                }
+                builder.indices.push_back(it->second);
+            }
+
+        private:
+            LvkModel::Builder &builder;
+            std::unordered_map<LvkModel::Vertex, uint32_t> uniqueVertices{};
+        };
+
+        void loadObj(LvkModel::Builder &builder, const std::string &filepath) {
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+            if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
+                throw std::runtime_error(warn + err);
+            }
+
+            VertexDeduplicator deduplicator{builder};
+            for (const auto &shape : shapes) {
+                for (const auto &index : shape.mesh.indices) {
+                    LvkModel::Vertex vertex{};
+                    if (index.vertex_index >= 0) {
+                        size_t i = 3 * static_cast<size_t>(index.vertex_index);
+                        vertex.position = {attrib.vertices[i + 0], attrib.vertices[i + 1]};
+                        // tinyobj fills in white when the file has no vertex colors
+                        vertex.color = {attrib.colors[i + 0], attrib.colors[i + 1], attrib.colors[i + 2]};
+                    }
+                    deduplicator.add(vertex);
+                }
+            }
+        }
+
+        // Node transforms, materials and non-triangle primitives are ignored.
+        void loadGltf(LvkModel::Builder &builder, const std::string &filepath) {
+            cgltf_options options{};
+            cgltf_data *data = nullptr;
+            if (cgltf_parse_file(&options, filepath.c_str(), &data) != cgltf_result_success) {
+                throw std::runtime_error("failed to parse glTF file: " + filepath);
+            }
+            if (cgltf_load_buffers(&options, data, filepath.c_str()) != cgltf_result_success) {
+                cgltf_free(data);
+                throw std::runtime_error("failed to load glTF buffers: " + filepath);
+            }
+            // checks accessors against their buffer views and indices against the vertex count;
+            // the reads below trust both
+            if (cgltf_validate(data) != cgltf_result_success) {
+                cgltf_free(data);
+                throw std::runtime_error("invalid glTF file: " + filepath);
+            }
+
+            VertexDeduplicator deduplicator{builder};
+            for (cgltf_size m = 0; m < data->meshes_count; m++) {
+                const cgltf_mesh &mesh = data->meshes[m];
+                for (cgltf_size p = 0; p < mesh.primitives_count; p++) {
+                    const cgltf_primitive &primitive = mesh.primitives[p];
+                    if (primitive.type != cgltf_primitive_type_triangles) continue;
+
+                    const cgltf_accessor *positions = nullptr;
+                    const cgltf_accessor *colors = nullptr;
+                    for (cgltf_size a = 0; a < primitive.attributes_count; a++) {
+                        const cgltf_attribute &attribute = primitive.attributes[a];
+                        if (attribute.type == cgltf_attribute_type_position) positions = attribute.data;
+                        if (attribute.type == cgltf_attribute_type_color && attribute.index == 0) colors = attribute.data;
+                    }
+                    if (positions == nullptr) continue;
+
+                    auto readVertex = [&](cgltf_size i) {
+                        LvkModel::Vertex vertex{};
+                        float position[3] = {};
+                        cgltf_accessor_read_float(positions, i, position, 3);
+                        vertex.position = {position[0], position[1]};
+                        float color[4] = {1.f, 1.f, 1.f, 1.f};
+                        if (colors != nullptr) {
+                            cgltf_accessor_read_float(colors, i, color, 4);
+                        }
+                        vertex.color = {color[0], color[1], color[2]};
+                        return vertex;
+                    };
+                    cgltf_size count = primitive.indices != nullptr ? primitive.indices->count : positions->count;
+                    for (cgltf_size i = 0; i < count; i++) {
+                        cgltf_size vertexIndex = primitive.indices != nullptr
+                                                 ? cgltf_accessor_read_index(primitive.indices, i) : i;
+                        deduplicator.add(readVertex(vertexIndex));
+                    }
+                }
+            }
+            cgltf_free(data);
+        }
+    }
+
     LvkModel::LvkModel(LvkDevice &device, const std::vector<Vertex> &vertices) : lvkDevice{device} {
-        createVertexBuffers(vertices);
+        createVertexBuffers(vertices.data(), static_cast<uint32_t>(vertices.size()), false);
+    }
+
+    LvkModel::LvkModel(LvkDevice &device, const Builder &builder) : lvkDevice{device} {
+        const auto count = static_cast<uint32_t>(builder.vertices.size());
+        createVertexBuffers(builder.vertices.data(), count, !builder.indices.empty());
+        if (indexTypeFor(count) == VK_INDEX_TYPE_UINT16) {
+            std::vector<uint16_t> shortIndices(builder.indices.begin(), builder.indices.end());
+            createIndexBuffers(shortIndices.data(), static_cast<uint32_t>(shortIndices.size()), VK_INDEX_TYPE_UINT16);
+        } else {
+            createIndexBuffers(builder.indices.data(), static_cast<uint32_t>(builder.indices.size()), VK_INDEX_TYPE_UINT32);
+        }
+    }
+
+    LvkModel::LvkModel(LvkDevice &device, const MeshData &data) : lvkDevice{device} {
+        createVertexBuffers(data.vertices, data.vertexCount, data.indexCount > 0);
+        createIndexBuffers(data.indices, data.indexCount, data.indexType);
+    }
+
+    LvkModel::LoadedMesh::LoadedMesh() = default;
+    LvkModel::LoadedMesh::~LoadedMesh() = default;
+    LvkModel::LoadedMesh::LoadedMesh(LoadedMesh &&) noexcept = default;
+    LvkModel::LoadedMesh &LvkModel::LoadedMesh::operator=(LoadedMesh &&) noexcept = default;
+
+    std::unique_ptr<LvkModel> LvkModel::createModelFromFile(LvkDevice &device, const std::string &filepath) {
+        LoadedMesh mesh = loadMeshFile(filepath);
+        return std::make_unique<LvkModel>(device, mesh.data);
+    }
+
+    LvkModel::LoadedMesh LvkModel::loadMeshFile(const std::string &filepath) {
+        LoadedMesh mesh{};
+        const std::string cachePath = filepath + ".lvkmesh";
+        if ((mesh.cache = LvkMeshCache::open(cachePath, filepath))) {
+            mesh.data = mesh.cache->meshData();
+            return mesh;
+        }
+
+        Builder builder{};
+        builder.loadModel(filepath);
+        mesh.vertices = std::move(builder.vertices);
+        mesh.data.vertices = mesh.vertices.data();
+        mesh.data.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        mesh.data.indexCount = static_cast<uint32_t>(builder.indices.size());
+        mesh.data.indexType = indexTypeFor(mesh.data.vertexCount);
+        if (mesh.data.indexType == VK_INDEX_TYPE_UINT16) {
+            mesh.indices.resize(builder.indices.size() * sizeof(uint16_t));
+            auto *shortIndices = reinterpret_cast<uint16_t *>(mesh.indices.data());
+            std::copy(builder.indices.begin(), builder.indices.end(), shortIndices);
+        } else {
+            mesh.indices.resize(builder.indices.size() * sizeof(uint32_t));
+            memcpy(mesh.indices.data(), builder.indices.data(), mesh.indices.size());
+        }
+        mesh.data.indices = mesh.indices.data();
+
+        try {
+            LvkMeshCache::write(cachePath, filepath, mesh.data);
+        } catch (const std::exception &e) {
+            // a read-only asset directory only costs us the warm start
+            std::cerr << "failed to write mesh cache: " << e.what() << std::endl;
+        }
+        return mesh;
+    }
+
+    VkIndexType LvkModel::indexTypeFor(uint32_t vertexCount) {
+        return vertexCount <= std::numeric_limits<uint16_t>::max() ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
     }
 
     LvkModel::~LvkModel() {
-        vkDestroyBuffer(lvkDevice.device(), vertexBuffer, nullptr);
-        vkFreeMemory(lvkDevice.device(), vertexBufferMemory, nullptr);
+        if (!ready) {
+            // no frame has acquired the buffers, so the deleter's frame may not cover the copies
+            lvkDevice.uploadQueue().cancelAcquires(vertexBuffer);
+            lvkDevice.uploadQueue().cancelAcquires(indexBuffer);
+            lvkDevice.uploadQueue().wait(uploadTicket);
+        }
+        lvkDevice.deletionQueue().enqueue(
+                [device = lvkDevice.device(), &allocator = lvkDevice.allocator(), vertexBuffer = vertexBuffer,
+                 vertexAllocation = vertexAllocation, indexBuffer = indexBuffer,
+                 indexAllocation = indexAllocation]() mutable {
+                    vkDestroyBuffer(device, vertexBuffer, nullptr);
+                    allocator.free(vertexAllocation);
+                    if (indexBuffer != VK_NULL_HANDLE) {
+                        vkDestroyBuffer(device, indexBuffer, nullptr);
+                        allocator.free(indexAllocation);
+                    }
+                });
     }
 
-    void LvkModel::createVertexBuffers(const std::vector<Vertex> &vertices) {
-        vertexCount = static_cast<uint32_t>(vertices.size());
-        assert(vertexCount >= 3 && "Vertex count must be at least 3");
-        VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
+    void LvkModel::createVertexBuffers(const Vertex *vertices, uint32_t count, bool indexed) {
+        vertexCount = count;
+        // deduplicated triangles may share fewer than 3 distinct vertices, e.g. degenerate ones
+        assert(vertexCount >= (indexed ? 1u : 3u) && "Vertex count must be at least 3, or 1 when indexed");
+        VkDeviceSize bufferSize = sizeof(Vertex) * vertexCount;
         lvkDevice.createBuffer(
                 bufferSize,
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 vertexBuffer,
-                vertexBufferMemory);
-        void *data;
-        vkMapMemory(lvkDevice.device(), vertexBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-        vkUnmapMemory(lvkDevice.device(), vertexBufferMemory);
+                vertexAllocation);
+        uploadTicket = lvkDevice.uploadQueue().enqueueBufferUpload(vertexBuffer, 0, vertices, bufferSize);
+    }
+
+    void LvkModel::createIndexBuffers(const void *indices, uint32_t count, VkIndexType type) {
+        indexCount = count;
+        indexType = type;
+        hasIndexBuffer = indexCount > 0;
+        if (!hasIndexBuffer) {
+            return;
+        }
+        assert(indexCount >= 3 && "Index count must be at least 3");
+        VkDeviceSize bufferSize = (type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t)) * indexCount;
+
+        lvkDevice.createBuffer(
+                bufferSize,
+                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                indexBuffer,
+                indexAllocation);
+        // both copies land in the same or a later batch, so the later ticket covers the vertex data too
+        uploadTicket = lvkDevice.uploadQueue().enqueueBufferUpload(indexBuffer, 0, indices, bufferSize);
+    }
+
+    bool LvkModel::isReady() {
+        if (!ready) {
+            ready = lvkDevice.uploadQueue().isComplete(uploadTicket);
+        }
+        return ready;
     }
 
-    void LvkModel::draw(VkCommandBuffer commandBuffer) {
-        vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+    void LvkModel::draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) {
+        if (hasIndexBuffer) {
+            vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, 0, 0, firstInstance);
+        } else {
+            vkCmdDraw(commandBuffer, vertexCount, instanceCount, 0, firstInstance);
+        }
     }
 
     void LvkModel::bind(VkCommandBuffer commandBuffer) {
         VkBuffer buffers[] = {vertexBuffer};
         VkDeviceSize offsets[] = {0};
         vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+        if (hasIndexBuffer) {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
+        }
     }
 
     std::vector<VkVertexInputBindingDescription> LvkModel::Vertex::getBindingDescriptions() {
@@ -61,4 +297,33 @@ namespace lvk {
 
         return attributeDescriptions;
     }
-}
\ No newline at end of file
+
+    LvkModel::Builder LvkModel::Builder::fromTriangleList(const std::vector<Vertex> &triangleVertices) {
+        Builder builder{};
+        builder.indices.reserve(triangleVertices.size());
+        VertexDeduplicator deduplicator{builder};
+        for (const auto &vertex : triangleVertices) {
+            deduplicator.add(vertex);
+        }
+        return builder;
+    }
+
+    void LvkModel::Builder::loadModel(const std::string &filepath) {
+        vertices.clear();
+        indices.clear();
+
+        std::string extension = filepath.substr(std::min(filepath.find_last_of('.'), filepath.size()));
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".obj") {
+            loadObj(*this, filepath);
+        } else if (extension == ".gltf" || extension == ".glb") {
+            loadGltf(*this, filepath);
+        } else {
+            throw std::runtime_error("unsupported model format: " + filepath);
+        }
+        if (indices.empty()) {
+            throw std::runtime_error("model has no triangles: " + filepath);
+        }
+    }
+}
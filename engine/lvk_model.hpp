@@ -6,9 +6,13 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace lvk {
+    class LvkMeshCache;
+
     class LvkModel {
     public:
 
@@ -17,23 +21,84 @@ namespace lvk {
             glm::vec3 color;
             static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
             static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+
+            bool operator==(const Vertex &other) const {
+                return position == other.position && color == other.color;
+            }
+        };
+
+        struct Builder {
+            std::vector<Vertex> vertices{};
+            std::vector<uint32_t> indices{};
+
+            // Collapses identical vertices of an unindexed triangle list into an indexed mesh.
+            static Builder fromTriangleList(const std::vector<Vertex> &triangleVertices);
+            // Loads .obj or .gltf/.glb triangles. Meshes are 2D here, so z is dropped.
+            void loadModel(const std::string &filepath);
+        };
+
+        // Upload-ready mesh whose indices already have their final width. The pointers are
+        // borrowed, e.g. from a memory-mapped cache file, and only read during construction.
+        struct MeshData {
+            const Vertex *vertices = nullptr;
+            uint32_t vertexCount = 0;
+            const void *indices = nullptr;
+            uint32_t indexCount = 0;
+            VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+        };
+
+        // CPU half of createModelFromFile, safe to run on any thread: either a mapped cache hit or
+        // the freshly parsed mesh with its indices packed to their upload width.
+        struct LoadedMesh {
+            LoadedMesh();
+            ~LoadedMesh();
+            LoadedMesh(LoadedMesh &&) noexcept;
+            LoadedMesh &operator=(LoadedMesh &&) noexcept;
+
+            MeshData data{};
+            std::unique_ptr<LvkMeshCache> cache;
+            std::vector<Vertex> vertices;
+            std::vector<uint8_t> indices;
         };
 
         LvkModel(LvkDevice &device, const std::vector<Vertex> &vertices);
+        LvkModel(LvkDevice &device, const Builder &builder);
+        LvkModel(LvkDevice &device, const MeshData &data);
         ~LvkModel();
 
         LvkModel(const LvkModel &) = delete;
         LvkModel &operator=(const LvkModel &) = delete;
 
         void bind(VkCommandBuffer commandBuffer);
-        void draw(VkCommandBuffer commandBuffer);
+        void draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+        // False until the staging copy into device-local memory has finished on the GPU.
+        bool isReady();
+
+        // Loads through the <filepath>.lvkmesh cache, (re)building it whenever it is missing or stale.
+        static std::unique_ptr<LvkModel> createModelFromFile(LvkDevice &device, const std::string &filepath);
+        static LoadedMesh loadMeshFile(const std::string &filepath);
+        // 16-bit indices halve index memory and fetch bandwidth whenever they can address every vertex.
+        static VkIndexType indexTypeFor(uint32_t vertexCount);
+
+        uint32_t getVertexCount() const { return vertexCount; }
+        uint32_t getIndexCount() const { return indexCount; }
 
     private:
-        void createVertexBuffers(const std::vector<Vertex> &vertices);
+        void createVertexBuffers(const Vertex *vertices, uint32_t count, bool indexed);
+        void createIndexBuffers(const void *indices, uint32_t count, VkIndexType type);
 
         LvkDevice &lvkDevice;
         VkBuffer vertexBuffer;
-        VkDeviceMemory vertexBufferMemory;
+        LvkAllocation vertexAllocation;
         uint32_t vertexCount;
+
+        bool hasIndexBuffer = false;
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        LvkAllocation indexAllocation;
+        uint32_t indexCount = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+        LvkUploadTicket uploadTicket = 0;
+        bool ready = false;
     };
-}
\ No newline at end of file
+}
@@ -11,14 +11,39 @@ namespace lvk {
             const std::string &vertFilepath,
             const std::string &fragFilepath,
             const PipelineConfigInfo &configInfo)
-            : lvkDevice{device} {
-        createGraphicsPipeline(vertFilepath, fragFilepath, configInfo);
+            : lvkDevice{device}, ownsShaderModules{true} {
+        auto vertCode = readFile(vertFilepath);
+        auto fragCode = readFile(fragFilepath);
+        std::cout << "Vertex Shader Code Size: " << vertCode.size() << "\n";
+        std::cout << "Fragment Shader Code Size: " << fragCode.size() << "\n";
+
+        createShaderModule(vertCode, &vertShaderModule);
+        createShaderModule(fragCode, &fragShaderModule);
+        createGraphicsPipeline(configInfo);
+    }
+
+    LvkPipeline::LvkPipeline(
+            LvkDevice &device,
+            VkShaderModule vertShaderModule,
+            VkShaderModule fragShaderModule,
+            const PipelineConfigInfo &configInfo)
+            : lvkDevice{device},
+              vertShaderModule{vertShaderModule},
+              fragShaderModule{fragShaderModule},
+              ownsShaderModules{false} {
+        createGraphicsPipeline(configInfo);
     }
 
     LvkPipeline::~LvkPipeline() {
-        vkDestroyShaderModule(lvkDevice.device(), vertShaderModule, nullptr);
-        vkDestroyShaderModule(lvkDevice.device(), fragShaderModule, nullptr);
-        vkDestroyPipeline(lvkDevice.device(), graphicsPipeline, nullptr);
+        if (ownsShaderModules) {
+            // modules are only read while the pipeline is created
+            vkDestroyShaderModule(lvkDevice.device(), vertShaderModule, nullptr);
+            vkDestroyShaderModule(lvkDevice.device(), fragShaderModule, nullptr);
+        }
+        // frames in flight may still be drawing with it
+        lvkDevice.deletionQueue().enqueue([device = lvkDevice.device(), pipeline = graphicsPipeline] {
+            vkDestroyPipeline(device, pipeline, nullptr);
+        });
     }
 
     std::vector<char> LvkPipeline::readFile(const std::string &filepath) {
@@ -34,19 +59,12 @@ namespace lvk {
         return buffer;
     }
 
-    void LvkPipeline::createGraphicsPipeline(const std::string &vertFilepath,
-                                             const std::string &fragFilepath,
-                                             const PipelineConfigInfo &configInfo) {
+    void LvkPipeline::createGraphicsPipeline(const PipelineConfigInfo &configInfo) {
         assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no pipelineLayout provided in configInfo");
         assert(configInfo.renderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline:: no renderPass provided in configInfo");
-        auto vertCode = readFile(vertFilepath);
-        auto fragCode = readFile(fragFilepath);
-        std::cout << "Vertex Shader Code Size: " << vertCode.size() << "\n";
-        std::cout << "Fragment Shader Code Size: " << fragCode.size() << "\n";
-
-        createShaderModule(vertCode, &vertShaderModule);
-        createShaderModule(fragCode, &fragShaderModule);
-
+        VkSpecializationInfo specializationInfo = configInfo.specialization.info();
+        const VkSpecializationInfo *pSpecializationInfo =
+                configInfo.specialization.empty() ? nullptr : &specializationInfo;
         VkPipelineShaderStageCreateInfo shaderStages[2];
         shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -54,7 +72,7 @@ namespace lvk {
         shaderStages[0].pName = "main";
         shaderStages[0].flags = 0;
         shaderStages[0].pNext = nullptr;
-        shaderStages[0].pSpecializationInfo = nullptr;
+        shaderStages[0].pSpecializationInfo = pSpecializationInfo;
 
         shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -62,10 +80,10 @@ namespace lvk {
         shaderStages[1].pName = "main";
         shaderStages[1].flags = 0;
         shaderStages[1].pNext = nullptr;
-        shaderStages[1].pSpecializationInfo = nullptr;
+        shaderStages[1].pSpecializationInfo = pSpecializationInfo;
 
-        auto bindingDescriptions = LvkModel::Vertex::getBindingDescriptions();
-        auto attributeDescriptions = LvkModel::Vertex::getAttributeDescriptions();
+        auto &bindingDescriptions = configInfo.bindingDescriptions;
+        auto &attributeDescriptions = configInfo.attributeDescriptions;
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
@@ -73,6 +91,13 @@ namespace lvk {
         vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
         vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 
+        // configInfo may be a copy, so re-point the state that refers into it
+        VkPipelineColorBlendStateCreateInfo colorBlendInfo = configInfo.colorBlendInfo;
+        colorBlendInfo.pAttachments = &configInfo.colorBlendAttachment;
+        VkPipelineDynamicStateCreateInfo dynamicStateInfo = configInfo.dynamicStateInfo;
+        dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
+        dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
+
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.stageCount = 2;
@@ -82,9 +107,9 @@ namespace lvk {
         pipelineInfo.pViewportState = &configInfo.viewportInfo;
         pipelineInfo.pRasterizationState = &configInfo.rasterizationInfo;
         pipelineInfo.pMultisampleState = &configInfo.multisampleInfo;
-        pipelineInfo.pColorBlendState = &configInfo.colorBlendInfo;
+        pipelineInfo.pColorBlendState = &colorBlendInfo;
         pipelineInfo.pDepthStencilState = &configInfo.depthStencilInfo;
-        pipelineInfo.pDynamicState = &configInfo.dynamicStateInfo;
+        pipelineInfo.pDynamicState = &dynamicStateInfo;
 
         pipelineInfo.layout = configInfo.pipelineLayout;
         pipelineInfo.renderPass = configInfo.renderPass;
@@ -93,7 +118,7 @@ namespace lvk {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(lvkDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS){
+        if (vkCreateGraphicsPipelines(lvkDevice.device(), lvkDevice.pipelineCache().handle(), 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS){
             throw std::runtime_error("failed to create graphics pipeline");
         }
     }
@@ -181,5 +206,8 @@ namespace lvk {
         configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
         configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
         configInfo.dynamicStateInfo.flags = 0;
+
+        configInfo.bindingDescriptions = LvkModel::Vertex::getBindingDescriptions();
+        configInfo.attributeDescriptions = LvkModel::Vertex::getAttributeDescriptions();
     }
 }
\ No newline at end of file
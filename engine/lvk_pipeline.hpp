@@ -1,10 +1,13 @@
 #pragma once
 
 #include "lvk_device.hpp"
+#include "lvk_specialization.hpp"
 #include <string>
 #include <vector>
 namespace lvk {
     struct PipelineConfigInfo {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
         VkPipelineViewportStateCreateInfo viewportInfo;
         VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
         VkPipelineRasterizationStateCreateInfo rasterizationInfo;
@@ -17,6 +20,8 @@ namespace lvk {
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
+        // applied to both stages; see LvkShaderPermutations for building them from a feature mask
+        LvkSpecializationConstants specialization{};
     };
     class LvkPipeline {
     public:
@@ -24,6 +29,11 @@ namespace lvk {
                     const std::string& vertFilepath,
                     const std::string& fragFilepath,
                     const PipelineConfigInfo &configInfo);
+        // Borrows the shader modules; they must outlive pipeline creation (LvkPipelineRegistry owns them).
+        LvkPipeline(LvkDevice &device,
+                    VkShaderModule vertShaderModule,
+                    VkShaderModule fragShaderModule,
+                    const PipelineConfigInfo &configInfo);
         ~LvkPipeline();
         LvkPipeline(const LvkPipeline&) = delete;
         LvkPipeline& operator=(const LvkPipeline&) = delete;
@@ -31,17 +41,16 @@ namespace lvk {
         void bind(VkCommandBuffer commandBuffer);
 
         static void defaultPipelineConfigInfo (PipelineConfigInfo& configInfo );
-    private:
         static std::vector<char> readFile(const std::string& filepath);
-        void createGraphicsPipeline(const std::string& vertFilepath,
-                                    const std::string& fragFilepath,
-                                    const PipelineConfigInfo &configInfo);
+    private:
+        void createGraphicsPipeline(const PipelineConfigInfo &configInfo);
 
         void createShaderModule(const std::vector<char> code, VkShaderModule* shaderModule);
         LvkDevice &lvkDevice;
         VkPipeline graphicsPipeline;
         VkShaderModule vertShaderModule;
         VkShaderModule fragShaderModule;
+        bool ownsShaderModules;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "lvk_pipeline_cache.hpp"
+#include "lvk_device.hpp"
+#include "lvk_utils.hpp"
+
+//std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace lvk {
+
+    LvkPipelineCache::LvkPipelineCache(LvkDevice &device, std::string path) : lvkDevice{device}, path{std::move(path)} {
+        std::string data;
+        std::ifstream in{this->path, std::ios::binary};
+        if (in.is_open()) {
+            data.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+        }
+        loaded = isCompatible(data);
+
+        VkPipelineCacheCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        createInfo.initialDataSize = loaded ? data.size() : 0;
+        createInfo.pInitialData = loaded ? data.data() : nullptr;
+        if (vkCreatePipelineCache(lvkDevice.device(), &createInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+    }
+
+    LvkPipelineCache::~LvkPipelineCache() {
+        try {
+            save();
+        } catch (const std::exception &e) {
+            std::cerr << "pipeline cache not saved: " << e.what() << '\n';
+        }
+        vkDestroyPipelineCache(lvkDevice.device(), pipelineCache, nullptr);
+    }
+
+    bool LvkPipelineCache::isCompatible(const std::string &data) const {
+        // the driver rejects foreign data too, but checking first keeps a stale file from ever reaching it
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        const auto &properties = lvkDevice.properties;
+        return header.headerSize >= sizeof(header) &&
+               header.headerSize <= data.size() &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == properties.vendorID &&
+               header.deviceID == properties.deviceID &&
+               std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void LvkPipelineCache::save() {
+        size_t size = 0;
+        if (vkGetPipelineCacheData(lvkDevice.device(), pipelineCache, &size, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("failed to query pipeline cache size");
+        }
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(lvkDevice.device(), pipelineCache, &size, data.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to read pipeline cache data");
+        }
+
+        // write next to the target and rename over it, so a crash never leaves a torn cache
+        const std::string tmpPath = uniqueTempPath(path);
+        {
+            std::ofstream out{tmpPath, std::ios::binary | std::ios::trunc};
+            if (!out.is_open()) {
+                throw std::runtime_error("failed to open pipeline cache for writing: " + tmpPath);
+            }
+            out.write(data.data(), static_cast<std::streamsize>(size));
+            if (!out) {
+                out.close();
+                // the name is unique, so nothing else would ever overwrite it
+                std::error_code ec;
+                std::filesystem::remove(tmpPath, ec);
+                throw std::runtime_error("failed to write pipeline cache: " + tmpPath);
+            }
+        }
+        std::filesystem::rename(tmpPath, path);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <string>
+
+namespace lvk {
+    class LvkDevice;
+
+    // Device-wide VkPipelineCache persisted between runs. The file is only used when its header
+    // matches this device (vendor, device and pipelineCacheUUID), so a driver update or a different
+    // GPU simply starts with an empty cache. Saving replaces the file atomically.
+    class LvkPipelineCache {
+    public:
+        static constexpr const char *DEFAULT_PATH = "lvk_pipeline_cache.bin";
+
+        LvkPipelineCache(LvkDevice &device, std::string path = DEFAULT_PATH);
+        // Saves before destroying the cache; failures are logged rather than thrown.
+        ~LvkPipelineCache();
+
+        LvkPipelineCache(const LvkPipelineCache &) = delete;
+        LvkPipelineCache &operator=(const LvkPipelineCache &) = delete;
+
+        VkPipelineCache handle() const { return pipelineCache; }
+        // True when the cache was seeded from disk.
+        bool wasLoaded() const { return loaded; }
+        void save();
+
+    private:
+        bool isCompatible(const std::string &data) const;
+
+        LvkDevice &lvkDevice;
+        std::string path;
+        VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+        bool loaded = false;
+    };
+}
@@ -0,0 +1,448 @@
+#include "lvk_pipeline_registry.hpp"
+#include "lvk_job_system.hpp"
+
+//std
+#include <cassert>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+namespace lvk {
+
+    namespace {
+        // Builds an exact binary key field by field. Whole structs are only appended when they
+        // consist of 4-byte members, so no padding bytes end up in the key.
+        class KeyWriter {
+        public:
+            template <typename T>
+            void add(const T &value) {
+                static_assert(std::is_trivially_copyable_v<T>, "key fields must be trivially copyable");
+                bytes.append(reinterpret_cast<const char *>(&value), sizeof(T));
+            }
+
+            template <typename T>
+            void addAll(const T *values, size_t count) {
+                add(static_cast<uint64_t>(values == nullptr ? 0 : count));
+                for (size_t i = 0; values != nullptr && i < count; i++) {
+                    add(values[i]);
+                }
+            }
+
+            std::string take() { return std::move(bytes); }
+
+        private:
+            std::string bytes;
+        };
+    }
+
+    LvkPipelineHandle::LvkPipelineHandle(std::shared_ptr<LvkPipeline> pipeline) : state{std::make_shared<State>()} {
+        state->pipeline = std::move(pipeline);
+        state->done.store(true, std::memory_order_release);
+    }
+
+    LvkPipeline *LvkPipelineHandle::get() const {
+        if (!isReady()) {
+            return nullptr;
+        }
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+        return state->pipeline.get();
+    }
+
+    LvkPipeline *LvkPipelineHandle::getOr(LvkPipeline *fallback) const {
+        LvkPipeline *pipeline = get();
+        return pipeline != nullptr ? pipeline : fallback;
+    }
+
+    LvkPipelineRegistry::LvkPipelineRegistry(LvkDevice &device) : lvkDevice{device} {}
+
+    LvkPipelineRegistry::~LvkPipelineRegistry() {
+        // compile jobs reference the registry and its shader modules
+        waitForCompiles();
+        compileJobs.reset();
+        pipelines.clear();
+        for (auto &entry : pipelineLayouts) {
+            vkDestroyPipelineLayout(lvkDevice.device(), entry.second, nullptr);
+        }
+        for (auto &entry : shaderModulesByCode) {
+            vkDestroyShaderModule(lvkDevice.device(), entry.second, nullptr);
+        }
+    }
+
+    VkPipelineLayout LvkPipelineRegistry::getPipelineLayout(
+            const std::vector<VkPushConstantRange> &pushConstantRanges,
+            const std::vector<VkDescriptorSetLayout> &setLayouts) {
+        KeyWriter key;
+        key.addAll(pushConstantRanges.data(), pushConstantRanges.size());
+        key.addAll(setLayouts.data(), setLayouts.size());
+        std::string layoutKey = key.take();
+
+        std::lock_guard<std::mutex> lock{mutex};
+        auto found = pipelineLayouts.find(layoutKey);
+        if (found != pipelineLayouts.end()) {
+            return found->second;
+        }
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+        pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+        pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+        pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
+        VkPipelineLayout pipelineLayout;
+        if (vkCreatePipelineLayout(lvkDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+        pipelineLayouts.emplace(std::move(layoutKey), pipelineLayout);
+        return pipelineLayout;
+    }
+
+    VkShaderModule LvkPipelineRegistry::getShaderModule(const std::string &filepath) {
+        std::lock_guard<std::mutex> lock{mutex};
+        return getShaderModuleLocked(filepath);
+    }
+
+    VkShaderModule LvkPipelineRegistry::getShaderModuleLocked(const std::string &filepath) {
+        auto byPath = shaderModulesByPath.find(filepath);
+        if (byPath != shaderModulesByPath.end()) {
+            return byPath->second;
+        }
+        auto code = LvkPipeline::readFile(filepath);
+        VkShaderModule shaderModule = createShaderModuleLocked({code.begin(), code.end()}, filepath);
+        shaderModulesByPath.emplace(filepath, shaderModule);
+        return shaderModule;
+    }
+
+    VkShaderModule LvkPipelineRegistry::createShaderModuleLocked(std::string code, const std::string &name) {
+        auto byCode = shaderModulesByCode.find(code);
+        if (byCode != shaderModulesByCode.end()) {
+            return byCode->second;
+        }
+
+        VkShaderModuleCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+        VkShaderModule shaderModule;
+        if (vkCreateShaderModule(lvkDevice.device(), &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create shader module: " + name);
+        }
+        shaderModulesByCode.emplace(std::move(code), shaderModule);
+        return shaderModule;
+    }
+
+    std::shared_ptr<LvkPipelineHandle::State> LvkPipelineRegistry::findOrInsertLocked(
+            const std::string &key, const std::string &vertFilepath, const std::string &fragFilepath,
+            const PipelineConfigInfo &configInfo, bool &inserted) {
+        auto found = pipelines.find(key);
+        inserted = found == pipelines.end();
+        if (!inserted) {
+            return found->second.state;
+        }
+        auto state = std::make_shared<State>();
+        pipelines.emplace(key, PipelineEntry{vertFilepath, fragFilepath, configInfo, state});
+        compilingCount++;
+        return state;
+    }
+
+    void LvkPipelineRegistry::finishCompile(
+            const std::string &key, const std::shared_ptr<State> &state, std::shared_ptr<LvkPipeline> pipeline,
+            std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (error) {
+            state->error = error;
+            pipelines.erase(key);
+        } else {
+            state->pipeline = std::move(pipeline);
+        }
+        compilingCount--;
+        state->done.store(true, std::memory_order_release);
+        compilesDone.notify_all();
+    }
+
+    std::shared_ptr<LvkPipeline> LvkPipelineRegistry::getPipeline(
+            const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo) {
+        return getPipelineHandle(vertFilepath, fragFilepath, configInfo).state->pipeline;
+    }
+
+    LvkPipelineHandle LvkPipelineRegistry::getPipelineHandle(
+            const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo) {
+        assert(!LvkJobSystem::onWorkerThread() && "getPipelineHandle blocks; use requestPipeline from jobs");
+        LvkPipelineHandle handle;
+        VkShaderModule vertShaderModule;
+        VkShaderModule fragShaderModule;
+        std::string key;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            vertShaderModule = getShaderModuleLocked(vertFilepath);
+            fragShaderModule = getShaderModuleLocked(fragFilepath);
+            key = pipelineKey(vertShaderModule, fragShaderModule, configInfo);
+            bool inserted;
+            handle.state = findOrInsertLocked(key, vertFilepath, fragFilepath, configInfo, inserted);
+            if (!inserted) {
+                // someone else is compiling it; wait for theirs rather than building it twice
+                compilesDone.wait(lock, [&] { return handle.isReady(); });
+                handle.get();
+                return handle;
+            }
+        }
+        // compile without the lock so other lookups are not held up
+        std::shared_ptr<LvkPipeline> pipeline;
+        std::exception_ptr error;
+        try {
+            pipeline = std::make_shared<LvkPipeline>(lvkDevice, vertShaderModule, fragShaderModule, configInfo);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        finishCompile(key, handle.state, std::move(pipeline), error);
+        handle.get();
+        return handle;
+    }
+
+    std::vector<std::shared_ptr<LvkPipeline>> LvkPipelineRegistry::getPipelines(
+            const std::vector<PipelineDesc> &descs, LvkJobSystem &jobSystem) {
+        struct Pending {
+            std::string key;
+            std::shared_ptr<State> state;
+            VkShaderModule vertShaderModule;
+            VkShaderModule fragShaderModule;
+            const PipelineConfigInfo *configInfo;
+        };
+        std::vector<std::shared_ptr<State>> states(descs.size());
+        std::vector<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            for (size_t i = 0; i < descs.size(); i++) {
+                VkShaderModule vert = getShaderModuleLocked(descs[i].vertFilepath);
+                VkShaderModule frag = getShaderModuleLocked(descs[i].fragFilepath);
+                std::string key = pipelineKey(vert, frag, descs[i].configInfo);
+                bool inserted;
+                states[i] = findOrInsertLocked(
+                        key, descs[i].vertFilepath, descs[i].fragFilepath, descs[i].configInfo, inserted);
+                if (inserted) {
+                    pending.push_back({std::move(key), states[i], vert, frag, &descs[i].configInfo});
+                }
+            }
+        }
+
+        jobSystem.parallelFor(static_cast<uint32_t>(pending.size()), 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t p = begin; p < end; p++) {
+                std::shared_ptr<LvkPipeline> pipeline;
+                std::exception_ptr error;
+                try {
+                    pipeline = std::make_shared<LvkPipeline>(
+                            lvkDevice, pending[p].vertShaderModule, pending[p].fragShaderModule,
+                            *pending[p].configInfo);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                finishCompile(pending[p].key, pending[p].state, std::move(pipeline), error);
+            }
+        });
+
+        // descs may also have matched compiles other callers started
+        std::unique_lock<std::mutex> lock{mutex};
+        compilesDone.wait(lock, [&] {
+            for (auto &state : states) {
+                if (!state->done.load(std::memory_order_acquire)) {
+                    return false;
+                }
+            }
+            return true;
+        });
+        std::vector<std::shared_ptr<LvkPipeline>> result(descs.size());
+        for (size_t i = 0; i < descs.size(); i++) {
+            if (states[i]->error) {
+                std::rethrow_exception(states[i]->error);
+            }
+            result[i] = states[i]->pipeline;
+        }
+        return result;
+    }
+
+    LvkPipelineHandle LvkPipelineRegistry::requestPipeline(
+            const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo) {
+        LvkPipelineHandle handle;
+        VkShaderModule vertShaderModule;
+        VkShaderModule fragShaderModule;
+        std::string key;
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            vertShaderModule = getShaderModuleLocked(vertFilepath);
+            fragShaderModule = getShaderModuleLocked(fragFilepath);
+            key = pipelineKey(vertShaderModule, fragShaderModule, configInfo);
+            bool inserted;
+            handle.state = findOrInsertLocked(key, vertFilepath, fragFilepath, configInfo, inserted);
+            if (!inserted) {
+                return handle;
+            }
+            if (!compileJobs) {
+                compileJobs = std::make_unique<LvkJobSystem>(COMPILE_WORKERS);
+            }
+        }
+
+        // the job owns copies of everything it needs; the caller's config may go out of scope
+        compileJobs->submit([this, state = handle.state, key = std::move(key), vertShaderModule, fragShaderModule,
+                             configInfo] {
+            // nobody waits on compileJobs, so no render thread can have picked this up mid-frame
+            assert(compileJobs->ownsCurrentThread() && "pipeline compile ran outside the compile workers");
+            std::shared_ptr<LvkPipeline> pipeline;
+            std::exception_ptr error;
+            try {
+                pipeline = std::make_shared<LvkPipeline>(lvkDevice, vertShaderModule, fragShaderModule, configInfo);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            finishCompile(key, state, std::move(pipeline), error);
+        });
+        return handle;
+    }
+
+    void LvkPipelineRegistry::waitForCompiles() {
+        std::unique_lock<std::mutex> lock{mutex};
+        compilesDone.wait(lock, [this] { return compilingCount == 0; });
+    }
+
+    size_t LvkPipelineRegistry::reloadShader(const std::string &filename, const std::vector<uint32_t> &code) {
+        struct Rebuild {
+            std::string oldKey;
+            std::string newKey;
+            std::shared_ptr<LvkPipeline> pipeline;
+        };
+        // in-flight compiles captured the old modules; let them land first so they get rebuilt too
+        std::unique_lock<std::mutex> lock{mutex};
+        compilesDone.wait(lock, [this] { return compilingCount == 0; });
+
+        std::unordered_set<std::string> paths;
+        for (auto &entry : shaderModulesByPath) {
+            if (std::filesystem::path{entry.first}.filename() == filename) {
+                paths.insert(entry.first);
+            }
+        }
+        if (paths.empty()) {
+            return 0;
+        }
+        // Old modules stay alive in shaderModulesByCode: another path may share them, and they
+        // are freed with the registry.
+        VkShaderModule shaderModule = createShaderModuleLocked(
+                {reinterpret_cast<const char *>(code.data()), code.size() * sizeof(uint32_t)}, filename);
+        auto moduleFor = [&](const std::string &filepath) {
+            return paths.count(filepath) ? shaderModule : shaderModulesByPath.at(filepath);
+        };
+
+        // build everything before touching any state, so a failing rebuild leaves all as it was
+        std::vector<Rebuild> rebuilds;
+        for (auto &entry : pipelines) {
+            const PipelineEntry &source = entry.second;
+            if (!paths.count(source.vertFilepath) && !paths.count(source.fragFilepath)) {
+                continue;
+            }
+            VkShaderModule vert = moduleFor(source.vertFilepath);
+            VkShaderModule frag = moduleFor(source.fragFilepath);
+            rebuilds.push_back({
+                    entry.first,
+                    pipelineKey(vert, frag, source.configInfo),
+                    std::make_shared<LvkPipeline>(lvkDevice, vert, frag, source.configInfo)});
+        }
+
+        for (auto &path : paths) {
+            shaderModulesByPath[path] = shaderModule;
+        }
+        for (auto &rebuild : rebuilds) {
+            auto node = pipelines.extract(rebuild.oldKey);
+            PipelineEntry &entry = node.mapped();
+            // the old pipeline defers its own destruction until the frames using it retire
+            entry.state->pipeline = std::move(rebuild.pipeline);
+            // If the new code matches a pipeline that already exists (say, an edit was undone), that
+            // entry keeps the key and this handle simply stops following later reloads.
+            node.key() = std::move(rebuild.newKey);
+            pipelines.insert(std::move(node));
+        }
+        return rebuilds.size();
+    }
+
+    size_t LvkPipelineRegistry::pipelineCount() {
+        std::lock_guard<std::mutex> lock{mutex};
+        size_t count = 0;
+        for (auto &entry : pipelines) {
+            if (entry.second.state->done.load(std::memory_order_acquire)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    std::string LvkPipelineRegistry::pipelineKey(
+            VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, const PipelineConfigInfo &configInfo) {
+        KeyWriter key;
+        key.add(vertShaderModule);
+        key.add(fragShaderModule);
+        key.addAll(configInfo.bindingDescriptions.data(), configInfo.bindingDescriptions.size());
+        key.addAll(configInfo.attributeDescriptions.data(), configInfo.attributeDescriptions.size());
+
+        const auto &viewport = configInfo.viewportInfo;
+        key.add(viewport.viewportCount);
+        key.add(viewport.scissorCount);
+        key.addAll(viewport.pViewports, viewport.viewportCount);
+        key.addAll(viewport.pScissors, viewport.scissorCount);
+
+        const auto &inputAssembly = configInfo.inputAssemblyInfo;
+        key.add(inputAssembly.topology);
+        key.add(inputAssembly.primitiveRestartEnable);
+
+        const auto &rasterization = configInfo.rasterizationInfo;
+        key.add(rasterization.depthClampEnable);
+        key.add(rasterization.rasterizerDiscardEnable);
+        key.add(rasterization.polygonMode);
+        key.add(rasterization.cullMode);
+        key.add(rasterization.frontFace);
+        key.add(rasterization.depthBiasEnable);
+        key.add(rasterization.depthBiasConstantFactor);
+        key.add(rasterization.depthBiasClamp);
+        key.add(rasterization.depthBiasSlopeFactor);
+        key.add(rasterization.lineWidth);
+
+        const auto &multisample = configInfo.multisampleInfo;
+        key.add(multisample.rasterizationSamples);
+        key.add(multisample.sampleShadingEnable);
+        key.add(multisample.minSampleShading);
+        key.addAll(multisample.pSampleMask, multisample.pSampleMask == nullptr ? 0 : 1);
+        key.add(multisample.alphaToCoverageEnable);
+        key.add(multisample.alphaToOneEnable);
+
+        key.add(configInfo.colorBlendAttachment);
+        const auto &colorBlend = configInfo.colorBlendInfo;
+        key.add(colorBlend.logicOpEnable);
+        key.add(colorBlend.logicOp);
+        key.add(colorBlend.attachmentCount);
+        key.add(colorBlend.blendConstants);
+
+        const auto &depthStencil = configInfo.depthStencilInfo;
+        key.add(depthStencil.depthTestEnable);
+        key.add(depthStencil.depthWriteEnable);
+        key.add(depthStencil.depthCompareOp);
+        key.add(depthStencil.depthBoundsTestEnable);
+        key.add(depthStencil.stencilTestEnable);
+        key.add(depthStencil.front);
+        key.add(depthStencil.back);
+        key.add(depthStencil.minDepthBounds);
+        key.add(depthStencil.maxDepthBounds);
+
+        key.addAll(configInfo.dynamicStateEnables.data(), configInfo.dynamicStateEnables.size());
+        key.add(configInfo.pipelineLayout);
+        key.add(configInfo.renderPass);
+        key.add(configInfo.subpass);
+
+        const auto &specialization = configInfo.specialization;
+        key.add(static_cast<uint64_t>(specialization.mapEntries().size()));
+        for (const auto &entry : specialization.mapEntries()) {
+            key.add(entry.constantID);
+            key.add(entry.offset);
+            key.add(static_cast<uint64_t>(entry.size));
+        }
+        key.addAll(specialization.data().data(), specialization.data().size());
+        return key.take();
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "lvk_pipeline.hpp"
+
+//std
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvk {
+    class LvkJobSystem;
+
+    // A pipeline that may still be compiling. Cheap to copy; every copy sees the same result.
+    class LvkPipelineHandle {
+    public:
+        LvkPipelineHandle() = default;
+        explicit LvkPipelineHandle(std::shared_ptr<LvkPipeline> pipeline);
+
+        bool isValid() const { return state != nullptr; }
+        // True once compilation has finished, successfully or not.
+        bool isReady() const { return state != nullptr && state->done.load(std::memory_order_acquire); }
+        // nullptr while compiling; rethrows the error if compilation failed.
+        LvkPipeline *get() const;
+        LvkPipeline *getOr(LvkPipeline *fallback) const;
+
+    private:
+        friend class LvkPipelineRegistry;
+
+        struct State {
+            std::atomic<bool> done{false};
+            std::shared_ptr<LvkPipeline> pipeline;
+            std::exception_ptr error;
+        };
+
+        std::shared_ptr<State> state;
+    };
+
+    // Owns every pipeline, pipeline layout and shader module of a device and hands out shared
+    // instances. Pipelines are keyed on their complete create state: shader modules, every field
+    // of PipelineConfigInfo, layout, render pass, subpass and specialization constants. Shader
+    // modules are deduplicated by SPIR-V contents and layouts by their push constant ranges and
+    // set layouts, so identical state asked for by different render systems resolves to the same
+    // handles and the same pipeline. Render passes are compared by handle; keep using one render
+    // pass object per compatibility class to share pipelines across them.
+    class LvkPipelineRegistry {
+    public:
+        struct PipelineDesc {
+            std::string vertFilepath;
+            std::string fragFilepath;
+            PipelineConfigInfo configInfo;
+        };
+
+        explicit LvkPipelineRegistry(LvkDevice &device);
+        ~LvkPipelineRegistry();
+
+        LvkPipelineRegistry(const LvkPipelineRegistry &) = delete;
+        LvkPipelineRegistry &operator=(const LvkPipelineRegistry &) = delete;
+
+        // The registry keeps ownership of everything it returns; never destroy these handles.
+        VkPipelineLayout getPipelineLayout(
+                const std::vector<VkPushConstantRange> &pushConstantRanges,
+                const std::vector<VkDescriptorSetLayout> &setLayouts = {});
+        VkShaderModule getShaderModule(const std::string &filepath);
+        std::shared_ptr<LvkPipeline> getPipeline(
+                const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo);
+        // Like getPipeline, but the handle follows the pipeline across reloadShader. Both block until
+        // the pipeline is built, including when another caller is already building it, so they must
+        // not be called from job system workers: the pool could fill up with waiting jobs.
+        LvkPipelineHandle getPipelineHandle(
+                const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo);
+        // Resolves all descs at once; the ones not built yet are compiled in parallel on jobSystem.
+        std::vector<std::shared_ptr<LvkPipeline>> getPipelines(
+                const std::vector<PipelineDesc> &descs, LvkJobSystem &jobSystem);
+        // Returns at once and compiles on the registry's own compile workers, so new pipelines never
+        // stall a frame: threads waiting on a render job system cannot pick up a compile, and
+        // recording jobs never queue behind one. Requests for a key that is already compiling share
+        // that compile.
+        LvkPipelineHandle requestPipeline(
+                const std::string &vertFilepath, const std::string &fragFilepath, const PipelineConfigInfo &configInfo);
+        // Blocks until every requestPipeline compile has finished.
+        void waitForCompiles();
+
+        // Replaces the code of every shader path whose file name is filename (e.g. "shader.vert.spv")
+        // and rebuilds the pipelines built from those paths, swapping them into their handles. Nothing
+        // changes if any rebuild throws. Replaced pipelines go through the device's deletion queue.
+        // Call between frames, from the thread that records them. Returns the number rebuilt.
+        size_t reloadShader(const std::string &filename, const std::vector<uint32_t> &code);
+
+        size_t pipelineCount();
+
+    private:
+        using State = LvkPipelineHandle::State;
+
+        // what a pipeline was built from, kept so reloadShader can build it again
+        struct PipelineEntry {
+            std::string vertFilepath;
+            std::string fragFilepath;
+            PipelineConfigInfo configInfo;
+            std::shared_ptr<State> state;
+        };
+
+        static std::string pipelineKey(
+                VkShaderModule vertShaderModule, VkShaderModule fragShaderModule, const PipelineConfigInfo &configInfo);
+        VkShaderModule getShaderModuleLocked(const std::string &filepath);
+        VkShaderModule createShaderModuleLocked(std::string code, const std::string &name);
+        // Returns the state stored under key, inserting a compiling one if there is none yet.
+        std::shared_ptr<State> findOrInsertLocked(
+                const std::string &key, const std::string &vertFilepath, const std::string &fragFilepath,
+                const PipelineConfigInfo &configInfo, bool &inserted);
+        void finishCompile(
+                const std::string &key, const std::shared_ptr<State> &state, std::shared_ptr<LvkPipeline> pipeline,
+                std::exception_ptr error);
+
+        static constexpr uint32_t COMPILE_WORKERS = 2;
+
+        LvkDevice &lvkDevice;
+        std::mutex mutex;
+        // created by the first requestPipeline; nothing else submits to or waits on it
+        std::unique_ptr<LvkJobSystem> compileJobs;
+        std::unordered_map<std::string, VkShaderModule> shaderModulesByPath;
+        // keyed on the SPIR-V itself, so identical code under different paths shares a module
+        std::unordered_map<std::string, VkShaderModule> shaderModulesByCode;
+        std::unordered_map<std::string, VkPipelineLayout> pipelineLayouts;
+        // includes pipelines still compiling; failed compiles are removed so they can be retried
+        std::unordered_map<std::string, PipelineEntry> pipelines;
+        uint32_t compilingCount = 0;
+        std::condition_variable compilesDone;
+    };
+}
@@ -1,4 +1,5 @@
 #include "lvk_renderer.hpp"
+#include "lvk_trace.hpp"
 
 #include <stdexcept>
 #include <array>
@@ -8,27 +9,34 @@
 
 namespace lvk {
 
-    LvkRenderer::LvkRenderer(LvkWindow &window, LvkDevice &device)
-        : lvkWindow{window}, lvkDevice{device} {
+    LvkRenderer::LvkRenderer(LvkWindow &window, LvkDevice &device, const LvkFramePolicy &policy)
+        : lvkWindow{&window}, lvkDevice{device}, framePolicy{policy}, frameCommands{device, 1, policy.framesInFlight},
+          frameProfiler{device, device.findPhysicalQueueFamilies().graphicsFamily, "frame", policy.framesInFlight} {
         recreateSwapChain();
-        createCommandBuffers();
     }
 
-    LvkRenderer::~LvkRenderer(){ freeCommandBuffers(); }
+    LvkRenderer::LvkRenderer(LvkDevice &device, VkExtent2D extent, const LvkFramePolicy &policy)
+        : lvkDevice{device}, offscreenExtent{extent}, framePolicy{policy}, frameCommands{device, 1, policy.framesInFlight},
+          frameProfiler{device, device.findPhysicalQueueFamilies().graphicsFamily, "frame", policy.framesInFlight} {
+        assert(device.isHeadless() && "Offscreen renderer requires a headless device");
+        recreateSwapChain();
+    }
+
+    LvkRenderer::~LvkRenderer(){ }
 
     void LvkRenderer::recreateSwapChain() {
-        auto extent = lvkWindow.getExtent();
-        while (extent.width == 0 || extent.height == 0){
-            extent = lvkWindow.getExtent();
-            glfwWaitEvents();
-        }
-        vkDeviceWaitIdle(lvkDevice.device());
+        LVK_TRACE_ZONE("recreateSwapChain");
+        auto extent = lvkWindow != nullptr ? lvkWindow->getExtent() : offscreenExtent;
+        // nothing waits for the GPU here: frames still using the old swap chain keep running, and
+        // its destructor hands everything to the deletion queue to be freed once they complete
+        lvkDevice.deletionQueue().collect(lvkDevice.graphicsTimeline().completedValue());
+        swapChainStale = false;
 
         if (lvkSwapChain == nullptr) {
-            lvkSwapChain = std::make_unique<LvkSwapChain>(lvkDevice, extent);
+            lvkSwapChain = std::make_unique<LvkSwapChain>(lvkDevice, extent, framePolicy);
         } else {
             std::shared_ptr<LvkSwapChain> oldSwapChain = std::move(lvkSwapChain);
-            lvkSwapChain = std::make_unique<LvkSwapChain>(lvkDevice, extent, oldSwapChain);
+            lvkSwapChain = std::make_unique<LvkSwapChain>(lvkDevice, extent, oldSwapChain, framePolicy);
 
             if (!oldSwapChain->compareSwapFormats(*lvkSwapChain.get())) {
                 throw std::runtime_error("Swap chain image(or depth) format has changed!");
@@ -36,30 +44,34 @@ namespace lvk {
         }
     }
 
-    void LvkRenderer::createCommandBuffers() {
-        commandBuffers.resize(LvkSwapChain::MAX_FRAMES_IN_FLIGHT);
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = lvkDevice.getCommandPool();
-        allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
-
-        if (vkAllocateCommandBuffers(lvkDevice.device(), &allocInfo, commandBuffers.data()) != VK_SUCCESS){
-            throw std::runtime_error("failed to allocate command buffers");
+    void LvkRenderer::waitBeforeInput() {
+        if (!framePolicy.waitBeforeInput) {
+            return;
         }
-    }
-
-    void LvkRenderer::freeCommandBuffers() {
-        vkFreeCommandBuffers(
-                lvkDevice.device(),
-                lvkDevice.getCommandPool(),
-                static_cast<uint32_t>(commandBuffers.size()),
-                commandBuffers.data());
-        commandBuffers.clear();
+        LVK_TRACE_ZONE("waitBeforeInput");
+        lvkDevice.graphicsTimeline().wait(lastFrameValue);
     }
 
     VkCommandBuffer LvkRenderer::beginFrame() {
         assert(!isFrameStarted && "Can't beginFrame while already in progress");
+        LVK_TRACE_ZONE("beginFrame");
+        if (lvkWindow != nullptr) {
+            if (lvkWindow->isMinimized()) {
+                return nullptr;
+            }
+            // all resize events since the last frame collapse into one recreation at the final size
+            if (lvkWindow->wasWindowResized()) {
+                lvkWindow->resetWindowResizedFlag();
+                auto extent = lvkWindow->getExtent();
+                auto current = lvkSwapChain->getSwapChainExtent();
+                swapChainStale = swapChainStale || extent.width != current.width || extent.height != current.height;
+            }
+            if (swapChainStale) {
+                recreateSwapChain();
+            }
+        }
+        // anything uploaded since the last frame is submitted ahead of this frame's commands
+        lvkDevice.uploadQueue().flush();
         auto result = lvkSwapChain->acquireNextImage(&currentImageIndex);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR){
@@ -71,35 +83,46 @@ namespace lvk {
         }
 
         isFrameStarted = true;
-        auto commandBuffer = getCurrentCommandBuffer();
+        lvkDevice.deletionQueue().collect(lvkDevice.graphicsTimeline().completedValue());
+        // acquireNextImage waited for this frame slot's previous submission, so its commands have retired
+        frameCommands.beginFrame(currentFrameIndex);
+        currentCommandBuffer = frameCommands.allocate(0, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+        auto commandBuffer = currentCommandBuffer;
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
         if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
             throw std::runtime_error("failed to begin recording command buffer");
         }
+        // buffers released by the transfer queue are acquired before anything in the frame reads them
+        uploadWait = lvkDevice.uploadQueue().recordAcquires(commandBuffer);
+        frameProfiler.beginSlot(commandBuffer, static_cast<uint32_t>(currentFrameIndex));
+        frameScope = frameProfiler.beginScope(commandBuffer, "frame");
         return commandBuffer;
     }
 
     void LvkRenderer::endFrame() {
         assert(isFrameStarted && "Can't call endFrame while frame is not in progress");
+        LVK_TRACE_ZONE("endFrame");
         auto commandBuffer = getCurrentCommandBuffer();
+        frameProfiler.endScope(commandBuffer, frameScope);
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer");
         }
-        auto result = lvkSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || lvkWindow.wasWindowResized()){
-            lvkWindow.resetWindowResizedFlag();
-            recreateSwapChain();
-        }
-
-        if (result != VK_SUCCESS){
-            throw std::runtime_error("failed to acquire swap chain image");
+        auto result = lvkSwapChain->submitCommandBuffers(&commandBuffer, &currentImageIndex, uploadWait);
+        lastFrameValue = lvkSwapChain->lastSubmittedValue();
+        // whatever was released up to now was last used by this frame at the latest
+        lvkDevice.deletionQueue().markSubmitted(lastFrameValue);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            swapChainStale = true;
+        } else if (result != VK_SUCCESS){
+            throw std::runtime_error("failed to present swap chain image");
         }
         isFrameStarted = false;
-        currentImageIndex = (currentImageIndex + 1) % LvkSwapChain::MAX_FRAMES_IN_FLIGHT;
+        currentFrameIndex = (currentFrameIndex + 1) % static_cast<int>(framePolicy.framesInFlight);
     }
 
-    void LvkRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer) {
+    void LvkRenderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
         assert(isFrameStarted && "Can't call beginSwapChainRenderPass if frame is not in progress");
         assert(commandBuffer == getCurrentCommandBuffer() &&
         "Can't begin render pass on command buffer from a different frame");
@@ -107,7 +130,7 @@ namespace lvk {
         VkRenderPassBeginInfo renderPathInfo{};
         renderPathInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
         renderPathInfo.renderPass = lvkSwapChain->getRenderPass();
-        renderPathInfo.framebuffer = lvkSwapChain->getFrameBuffer(currentImageIndex);
+        renderPathInfo.framebuffer = lvkSwapChain->getFrameBuffer(static_cast<int>(currentImageIndex), currentFrameIndex);
 
         renderPathInfo.renderArea.offset = {0, 0};
         renderPathInfo.renderArea.extent = lvkSwapChain->getSwapChainExtent();
@@ -119,7 +142,10 @@ namespace lvk {
         renderPathInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPathInfo.pClearValues = clearValues.data();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPathInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(commandBuffer, &renderPathInfo, contents);
+        if (contents != VK_SUBPASS_CONTENTS_INLINE) {
+            return;
+        }
 
         VkViewport viewport{};
         viewport.x = 0.0f;
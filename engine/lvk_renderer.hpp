@@ -3,6 +3,9 @@
 #include "lvk_window.hpp"
 #include "lvk_device.hpp"
 #include "lvk_swap_chain.hpp"
+#include "lvk_frame_policy.hpp"
+#include "lvk_command_allocator.hpp"
+#include "lvk_gpu_profiler.hpp"
 
 
 //std
@@ -13,42 +16,75 @@ namespace lvk {
     class LvkRenderer {
     public:
 
-        LvkRenderer(LvkWindow &window, LvkDevice &device);
+        LvkRenderer(LvkWindow &window, LvkDevice &device, const LvkFramePolicy &policy = {});
+        // Offscreen renderer for a headless LvkDevice, drawing into fixed size color+depth images.
+        LvkRenderer(LvkDevice &device, VkExtent2D extent, const LvkFramePolicy &policy = {});
         ~LvkRenderer();
 
         LvkRenderer(const LvkRenderer &) = delete;
         LvkRenderer &operator=(const LvkRenderer &) = delete;
 
         VkRenderPass getSwapChainRenderPass() const { return lvkSwapChain->getRenderPass(); }
+        VkExtent2D getExtent() const { return lvkSwapChain->getSwapChainExtent(); }
+        bool isHeadless() const { return lvkWindow == nullptr; }
         bool isFrameInProgress() const { return isFrameStarted; }
+        const LvkSwapChain::FrameTimings &getLastFrameTimings() const { return lvkSwapChain->lastFrameTimings(); }
+        const LvkFramePolicy &getFramePolicy() const { return framePolicy; }
+        const LvkSwapChain::DepthMemory &getDepthMemory() const { return lvkSwapChain->depthMemory(); }
+        // Each frame is wrapped in a "frame" scope; results arrive one frame per frame in flight late.
+        LvkGpuProfiler &gpuProfiler() { return frameProfiler; }
 
         VkCommandBuffer getCurrentCommandBuffer() const {
             assert(isFrameStarted && "Cannot get command buffer when freame not in progress");
-            return commandBuffers[currentFrameIndex];
+            return currentCommandBuffer;
         }
 
+        VkFramebuffer getCurrentFramebuffer() const {
+            assert(isFrameStarted && "Cannot get framebuffer when frame not in progress");
+            return lvkSwapChain->getFrameBuffer(static_cast<int>(currentImageIndex), currentFrameIndex);
+        }
+
+        // Graphics timeline value of the last submitted frame. It only grows; pass it to
+        // lvkDevice.graphicsTimeline() to check on or wait for exactly that frame.
+        uint64_t getLastFrameValue() const { return lastFrameValue; }
+
         int getFrameIndex() const {
             assert(isFrameStarted && "Cannot get frame index when frame not in progress");
             return currentFrameIndex;
         }
 
+        // Call right before polling input. Under a policy with waitBeforeInput it blocks until the
+        // last frame has finished on the GPU; otherwise it returns immediately.
+        void waitBeforeInput();
+        // Returns nullptr when there is nothing to draw to, e.g. while the window is minimized.
         VkCommandBuffer beginFrame();
         void endFrame();
-        void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // With SECONDARY_COMMAND_BUFFERS contents the viewport and scissor are left to the secondaries.
+        void beginSwapChainRenderPass(
+                VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
     private:
-        void createCommandBuffers();
-        void freeCommandBuffers();
         void recreateSwapChain();
 
-        LvkWindow& lvkWindow;
+        LvkWindow* lvkWindow = nullptr;
         LvkDevice& lvkDevice;
+        VkExtent2D offscreenExtent{};
+        LvkFramePolicy framePolicy;
         std::unique_ptr<LvkSwapChain> lvkSwapChain;
-        std::vector<VkCommandBuffer> commandBuffers;
+        // primaries are handed out per frame and recycled by resetting the frame's pool
+        LvkCommandAllocator frameCommands;
+        VkCommandBuffer currentCommandBuffer = VK_NULL_HANDLE;
+        // transfer batch the current frame acquired buffers from
+        LvkTimelineWait uploadWait{};
+        LvkGpuProfiler frameProfiler;
+        uint32_t frameScope = LvkGpuProfiler::INVALID_SCOPE;
 
         uint32_t currentImageIndex;
         int currentFrameIndex{0};
+        uint64_t lastFrameValue{0};
         bool isFrameStarted{false};
+        // set when presenting reported the swap chain out of date; recreated by the next beginFrame
+        bool swapChainStale{false};
     };
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "lvk_shader_hot_reload.hpp"
+#include "lvk_device.hpp"
+#include "lvk_pipeline_registry.hpp"
+#include "lvk_trace.hpp"
+
+#if defined(LVK_SHADER_HOT_RELOAD) && defined(__linux__)
+#include <shaderc/shaderc.hpp>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//std
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace lvk {
+
+    std::string LvkShaderHotReload::defaultSourceDir() {
+#ifdef LVK_SHADER_SOURCE_DIR
+        return LVK_SHADER_SOURCE_DIR;
+#else
+        return "../src/shaders";
+#endif
+    }
+
+#if defined(LVK_SHADER_HOT_RELOAD) && defined(__linux__)
+
+    namespace {
+        bool shaderKind(const std::string &extension, shaderc_shader_kind &kind) {
+            if (extension == ".vert") {
+                kind = shaderc_glsl_vertex_shader;
+            } else if (extension == ".frag") {
+                kind = shaderc_glsl_fragment_shader;
+            } else if (extension == ".comp") {
+                kind = shaderc_glsl_compute_shader;
+            } else {
+                return false;
+            }
+            return true;
+        }
+    }
+
+    LvkShaderHotReload::LvkShaderHotReload(LvkDevice &device, std::string sourceDir)
+            : lvkDevice{device}, sourceDir{std::move(sourceDir)} {
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd < 0) {
+            throw std::runtime_error(std::string{"failed to initialize inotify: "} + std::strerror(errno));
+        }
+        // editors either rewrite the file in place or rename a temporary over it
+        if (inotify_add_watch(inotifyFd, this->sourceDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            int error = errno;
+            close(inotifyFd);
+            throw std::runtime_error("failed to watch " + this->sourceDir + ": " + std::strerror(error));
+        }
+    }
+
+    LvkShaderHotReload::~LvkShaderHotReload() {
+        close(inotifyFd);
+    }
+
+    std::vector<std::string> LvkShaderHotReload::pollChangedFiles() {
+        // one save can produce several events; report each file once
+        std::vector<std::string> changed;
+        std::unordered_set<std::string> seen;
+        alignas(inotify_event) char buffer[4096];
+        while (true) {
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            for (char *at = buffer; at < buffer + length;) {
+                auto *event = reinterpret_cast<inotify_event *>(at);
+                at += sizeof(inotify_event) + event->len;
+                shaderc_shader_kind kind;
+                if (event->len == 0 || !shaderKind(std::filesystem::path{event->name}.extension().string(), kind)) {
+                    continue;
+                }
+                if (seen.insert(event->name).second) {
+                    changed.emplace_back(event->name);
+                }
+            }
+        }
+        return changed;
+    }
+
+    void LvkShaderHotReload::reload(const std::string &filename) {
+        std::string sourcePath = sourceDir + "/" + filename;
+        std::ifstream file{sourcePath, std::ios::binary};
+        if (!file.is_open()) {
+            std::cerr << "shader reload: failed to open " << sourcePath << '\n';
+            return;
+        }
+        std::string source{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        shaderc_shader_kind kind;
+        shaderKind(std::filesystem::path{filename}.extension().string(), kind);
+
+        // same target as the glslc invocation in add_shader
+        shaderc::Compiler compiler;
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_0);
+        shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, sourcePath.c_str(), options);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+            std::cerr << "shader reload: " << result.GetErrorMessage();
+            return;
+        }
+        std::vector<uint32_t> code{result.cbegin(), result.cend()};
+
+        size_t rebuilt;
+        try {
+            rebuilt = lvkDevice.pipelineRegistry().reloadShader(filename + ".spv", code);
+        } catch (const std::exception &e) {
+            std::cerr << "shader reload: " << filename << ": " << e.what() << '\n';
+            return;
+        }
+        std::cout << "shader reload: " << filename << ", " << rebuilt << " pipeline(s) rebuilt\n";
+    }
+
+    void LvkShaderHotReload::update() {
+        LVK_TRACE_ZONE("shaderHotReload");
+        for (auto &filename : pollChangedFiles()) {
+            reload(filename);
+        }
+    }
+
+#else
+
+    LvkShaderHotReload::LvkShaderHotReload(LvkDevice &device, std::string sourceDir)
+            : lvkDevice{device}, sourceDir{std::move(sourceDir)} {}
+
+    LvkShaderHotReload::~LvkShaderHotReload() {}
+
+    std::vector<std::string> LvkShaderHotReload::pollChangedFiles() { return {}; }
+
+    void LvkShaderHotReload::reload(const std::string &) {}
+
+    void LvkShaderHotReload::update() {}
+
+#endif
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+//std
+#include <string>
+#include <vector>
+
+namespace lvk {
+    class LvkDevice;
+
+    // Development mode that watches the GLSL sources, recompiles an edited shader in-process and
+    // rebuilds just the pipelines using it through the pipeline registry. Pipelines swapped out go
+    // through the device's deletion queue, so reloading never waits on the GPU. Needs a build with
+    // LVK_SHADER_HOT_RELOAD (shaderc) on Linux (inotify); otherwise SUPPORTED is false and update()
+    // does nothing.
+    class LvkShaderHotReload {
+    public:
+#if defined(LVK_SHADER_HOT_RELOAD) && defined(__linux__)
+        static constexpr bool SUPPORTED = true;
+#else
+        static constexpr bool SUPPORTED = false;
+#endif
+        // src/shaders of the source tree this build was configured from
+        static std::string defaultSourceDir();
+
+        explicit LvkShaderHotReload(LvkDevice &device, std::string sourceDir = defaultSourceDir());
+        ~LvkShaderHotReload();
+
+        LvkShaderHotReload(const LvkShaderHotReload &) = delete;
+        LvkShaderHotReload &operator=(const LvkShaderHotReload &) = delete;
+
+        // Call between frames, outside any recording. Compile errors are printed and leave the
+        // running pipelines in place.
+        void update();
+
+    private:
+        std::vector<std::string> pollChangedFiles();
+        void reload(const std::string &filename);
+
+        LvkDevice &lvkDevice;
+        std::string sourceDir;
+        int inotifyFd = -1;
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace lvk {
+    // Typed builder for VkSpecializationInfo. Constants are kept sorted by id, so the same values
+    // set in a different order produce identical data (and the same registry key). One set is
+    // passed to every stage of a pipeline; a stage ignores ids its shader does not declare.
+    class LvkSpecializationConstants {
+    public:
+        // bool is stored as a VkBool32, as the spec requires for boolean constants.
+        template <typename T>
+        LvkSpecializationConstants &set(uint32_t constantID, T value) {
+            static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+                                  std::is_same_v<T, float>,
+                          "specialization constants are bool, int32_t, uint32_t or float");
+            if constexpr (std::is_same_v<T, bool>) {
+                return setBytes(constantID, VkBool32{value ? VK_TRUE : VK_FALSE});
+            } else {
+                return setBytes(constantID, value);
+            }
+        }
+
+        bool empty() const { return entries.empty(); }
+        const std::vector<VkSpecializationMapEntry> &mapEntries() const { return entries; }
+        const std::vector<uint32_t> &data() const { return values; }
+
+        // Points into this object; keep it alive and unchanged while the result is in use.
+        VkSpecializationInfo info() const {
+            VkSpecializationInfo specializationInfo{};
+            specializationInfo.mapEntryCount = static_cast<uint32_t>(entries.size());
+            specializationInfo.pMapEntries = entries.data();
+            specializationInfo.dataSize = values.size() * sizeof(uint32_t);
+            specializationInfo.pData = values.data();
+            return specializationInfo;
+        }
+
+    private:
+        // every supported type is 4 bytes, so each constant takes one word of values
+        template <typename T>
+        LvkSpecializationConstants &setBytes(uint32_t constantID, T value) {
+            static_assert(sizeof(T) == sizeof(uint32_t));
+            uint32_t word;
+            std::memcpy(&word, &value, sizeof(word));
+            auto at = std::lower_bound(entries.begin(), entries.end(), constantID,
+                                       [](const VkSpecializationMapEntry &entry, uint32_t id) {
+                                           return entry.constantID < id;
+                                       });
+            size_t index = static_cast<size_t>(at - entries.begin());
+            if (at != entries.end() && at->constantID == constantID) {
+                values[index] = word;
+                return *this;
+            }
+            entries.insert(at, {constantID, 0, sizeof(uint32_t)});
+            values.insert(values.begin() + static_cast<std::ptrdiff_t>(index), word);
+            for (size_t i = index; i < entries.size(); i++) {
+                entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+            }
+            return *this;
+        }
+
+        std::vector<VkSpecializationMapEntry> entries;
+        std::vector<uint32_t> values;
+    };
+
+    // Maps the feature bits of a shader's permutation mask onto boolean specialization constants,
+    // so one GLSL source yields a variant per mask with the branches of disabled features removed
+    // when the pipeline is created rather than taken at runtime.
+    class LvkShaderPermutations {
+    public:
+        // Feature bit (a single-bit mask) drives the bool constant constantID.
+        LvkShaderPermutations &feature(uint32_t bit, uint32_t constantID) {
+            assert(bit != 0 && (bit & (bit - 1)) == 0 && "a feature is a single bit");
+            assert((declared & bit) == 0 && "feature declared twice");
+            declared |= bit;
+            features.push_back({bit, constantID});
+            return *this;
+        }
+
+        // Sets the constant of every declared feature, false where its bit is clear in mask.
+        void apply(uint32_t mask, LvkSpecializationConstants &constants) const {
+            assert((mask & ~declared) == 0 && "mask uses undeclared features");
+            for (const auto &feature : features) {
+                constants.set(feature.constantID, (mask & feature.bit) != 0);
+            }
+        }
+
+        LvkSpecializationConstants constants(uint32_t mask) const {
+            LvkSpecializationConstants result;
+            apply(mask, result);
+            return result;
+        }
+
+    private:
+        struct Feature {
+            uint32_t bit;
+            uint32_t constantID;
+        };
+
+        std::vector<Feature> features;
+        uint32_t declared = 0;
+    };
+}
@@ -1,6 +1,10 @@
 #include "lvk_swap_chain.hpp"
+#include "lvk_trace.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -9,17 +13,34 @@
 #include <stdexcept>
 
 namespace lvk {
-    LvkSwapChain::LvkSwapChain(LvkDevice &deviceRef, VkExtent2D extent)
-            : device{deviceRef}, windowExtent{extent} {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+        double elapsedMs(Clock::time_point since) {
+            return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+        }
+    }
+    LvkSwapChain::LvkSwapChain(LvkDevice &deviceRef, VkExtent2D extent, const LvkFramePolicy &policy)
+            : device{deviceRef}, windowExtent{extent}, policy{policy} {
         init();
     }
     LvkSwapChain::LvkSwapChain(
-            LvkDevice &deviceRef, VkExtent2D extent, std::shared_ptr<LvkSwapChain> previous)
-            : device{deviceRef}, windowExtent{extent}, oldSwapChain{previous} {
+            LvkDevice &deviceRef,
+            VkExtent2D extent,
+            std::shared_ptr<LvkSwapChain> previous,
+            const LvkFramePolicy &policy)
+            : device{deviceRef}, windowExtent{extent}, policy{policy}, oldSwapChain{previous} {
         init();
+        // Frames submitted through the previous swap chain may still be running, and the renderer's
+        // per-frame resources follow these slots, so continue where it left off.
+        assert(oldSwapChain->frameValues.size() == frameValues.size() && "frame policy changed across recreation");
+        frameValues = oldSwapChain->frameValues;
+        currentFrame = oldSwapChain->currentFrame;
+        lastFrameValue = oldSwapChain->lastFrameValue;
         oldSwapChain = nullptr;
     }
     void LvkSwapChain::init() {
+        assert(policy.framesInFlight >= 1 && policy.framesInFlight <= MAX_FRAMES_IN_FLIGHT &&
+               "frames in flight out of range");
         createSwapChain();
         createImageViews();
         createRenderPass();
@@ -28,37 +49,56 @@ namespace lvk {
         createSyncObjects();
     }
     LvkSwapChain::~LvkSwapChain() {
-        for (auto imageView : swapChainImageViews) {
-            vkDestroyImageView(device.device(), imageView, nullptr);
-        }
-        swapChainImageViews.clear();
-        if (swapChain != nullptr) {
-            vkDestroySwapchainKHR(device.device(), swapChain, nullptr);
-            swapChain = nullptr;
-        }
-        for (int i = 0; i < depthImages.size(); i++) {
-            vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-            vkDestroyImage(device.device(), depthImages[i], nullptr);
-            vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
-        }
-        for (auto framebuffer : swapChainFramebuffers) {
-            vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
-        }
-        vkDestroyRenderPass(device.device(), renderPass, nullptr);
-        // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-            vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-            vkDestroyFence(device.device(), inFlightFences[i], nullptr);
-        }
+        // a replaced swap chain may still be in use by frames in flight, so everything is deferred
+        device.deletionQueue().enqueue(
+                [vkDevice = device.device(), &allocator = device.allocator(), swapChain = swapChain,
+                 imageViews = std::move(swapChainImageViews), images = std::move(swapChainImages),
+                 offscreenAllocations = std::move(offscreenImageAllocations), depthImages = std::move(depthImages),
+                 depthAllocations = std::move(depthImageAllocations), depthImageViews = std::move(depthImageViews),
+                 framebuffers = std::move(swapChainFramebuffers), renderPass = renderPass,
+                 renderFinishedSemaphores = std::move(renderFinishedSemaphores),
+                 imageAvailableSemaphores = std::move(imageAvailableSemaphores)]() mutable {
+                    for (auto imageView : imageViews) {
+                        vkDestroyImageView(vkDevice, imageView, nullptr);
+                    }
+                    if (swapChain != nullptr) {
+                        vkDestroySwapchainKHR(vkDevice, swapChain, nullptr);
+                    }
+                    for (size_t i = 0; i < offscreenAllocations.size(); i++) {
+                        vkDestroyImage(vkDevice, images[i], nullptr);
+                        allocator.free(offscreenAllocations[i]);
+                    }
+                    for (size_t i = 0; i < depthImages.size(); i++) {
+                        vkDestroyImageView(vkDevice, depthImageViews[i], nullptr);
+                        vkDestroyImage(vkDevice, depthImages[i], nullptr);
+                        allocator.free(depthAllocations[i]);
+                    }
+                    for (auto framebuffer : framebuffers) {
+                        vkDestroyFramebuffer(vkDevice, framebuffer, nullptr);
+                    }
+                    vkDestroyRenderPass(vkDevice, renderPass, nullptr);
+                    // cleanup synchronization objects
+                    for (size_t i = 0; i < renderFinishedSemaphores.size(); i++) {
+                        vkDestroySemaphore(vkDevice, renderFinishedSemaphores[i], nullptr);
+                        vkDestroySemaphore(vkDevice, imageAvailableSemaphores[i], nullptr);
+                    }
+                });
     }
     VkResult LvkSwapChain::acquireNextImage(uint32_t *imageIndex) {
-        vkWaitForFences(
-                device.device(),
-                1,
-                &inFlightFences[currentFrame],
-                VK_TRUE,
-                std::numeric_limits<uint64_t>::max());
+        auto start = Clock::now();
+        {
+            LVK_TRACE_ZONE("fenceWait");
+            device.graphicsTimeline().wait(frameValues[currentFrame]);
+        }
+        frameTimings.fenceWaitMs = elapsedMs(start);
+        if (device.isHeadless()) {
+            // one offscreen image per frame in flight, so the wait above already covers it
+            *imageIndex = static_cast<uint32_t>(currentFrame);
+            frameTimings.acquireMs = 0.0;
+            return VK_SUCCESS;
+        }
+        start = Clock::now();
+        LVK_TRACE_ZONE("acquire");
         VkResult result = vkAcquireNextImageKHR(
                 device.device(),
                 swapChain,
@@ -66,30 +106,45 @@ namespace lvk {
                 imageAvailableSemaphores[currentFrame],  // must be a not signaled semaphore
                 VK_NULL_HANDLE,
                 imageIndex);
+        frameTimings.acquireMs = elapsedMs(start);
         return result;
     }
-    VkResult LvkSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) {
-        if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-            vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+    VkResult LvkSwapChain::submitCommandBuffers(
+            const VkCommandBuffer *buffers, uint32_t *imageIndex, const LvkTimelineWait &uploadWait) {
+        auto start = Clock::now();
+        if (!device.graphicsTimeline().isComplete(imageValues[*imageIndex])) {
+            LVK_TRACE_ZONE("imageFenceWait");
+            device.graphicsTimeline().wait(imageValues[*imageIndex]);
         }
-        imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
+        frameTimings.fenceWaitMs += elapsedMs(start);
+        start = Clock::now();
+        const bool headless = device.isHeadless();
         VkSubmitInfo submitInfo = {};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
         VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.waitSemaphoreCount = headless ? 0 : 1;
         submitInfo.pWaitSemaphores = waitSemaphores;
         submitInfo.pWaitDstStageMask = waitStages;
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = buffers;
         VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.signalSemaphoreCount = headless ? 0 : 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
-        vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-        if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
-            VK_SUCCESS) {
-            throw std::runtime_error("failed to submit draw command buffer!");
+        {
+            LVK_TRACE_ZONE("submit");
+            lastFrameValue = device.graphicsTimeline().submit(submitInfo, uploadWait);
+        }
+        frameValues[currentFrame] = lastFrameValue;
+        imageValues[*imageIndex] = lastFrameValue;
+        frameTimings.submitMs = elapsedMs(start);
+        if (headless) {
+            frameTimings.presentMs = 0.0;
+            currentFrame = (currentFrame + 1) % policy.framesInFlight;
+            return VK_SUCCESS;
         }
+        start = Clock::now();
+        LVK_TRACE_ZONE("present");
         VkPresentInfoKHR presentInfo = {};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
         presentInfo.waitSemaphoreCount = 1;
@@ -98,16 +153,27 @@ namespace lvk {
         presentInfo.swapchainCount = 1;
         presentInfo.pSwapchains = swapChains;
         presentInfo.pImageIndices = imageIndex;
-        auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        VkResult result;
+        if (device.presentQueue() == device.graphicsQueue()) {
+            auto queueLock = device.graphicsTimeline().lockQueue();
+            result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+        } else {
+            result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+        }
+        frameTimings.presentMs = elapsedMs(start);
+        currentFrame = (currentFrame + 1) % policy.framesInFlight;
         return result;
     }
     void LvkSwapChain::createSwapChain() {
+        if (device.isHeadless()) {
+            createOffscreenImages();
+            return;
+        }
         SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-        VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+        presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
         VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
-        uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+        uint32_t imageCount = swapChainSupport.capabilities.minImageCount + policy.extraImages;
         if (swapChainSupport.capabilities.maxImageCount > 0 &&
             imageCount > swapChainSupport.capabilities.maxImageCount) {
             imageCount = swapChainSupport.capabilities.maxImageCount;
@@ -150,6 +216,38 @@ namespace lvk {
         swapChainImageFormat = surfaceFormat.format;
         swapChainExtent = extent;
     }
+    void LvkSwapChain::createOffscreenImages() {
+        swapChainImageFormat = device.findSupportedFormat(
+                {VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB},
+                VK_IMAGE_TILING_OPTIMAL,
+                VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
+        swapChainExtent = windowExtent;
+
+        swapChainImages.resize(policy.framesInFlight);
+        offscreenImageAllocations.resize(policy.framesInFlight);
+        for (size_t i = 0; i < swapChainImages.size(); i++) {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width = swapChainExtent.width;
+            imageInfo.extent.height = swapChainExtent.height;
+            imageInfo.extent.depth = 1;
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = swapChainImageFormat;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageInfo.flags = 0;
+            device.createImageWithInfo(
+                    imageInfo,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    swapChainImages[i],
+                    offscreenImageAllocations[i]);
+        }
+    }
     void LvkSwapChain::createImageViews() {
         swapChainImageViews.resize(swapChainImages.size());
         for (size_t i = 0; i < swapChainImages.size(); i++) {
@@ -170,8 +268,16 @@ namespace lvk {
         }
     }
     void LvkSwapChain::createRenderPass() {
+        swapChainDepthFormat = findDepthFormat();
+        if (oldSwapChain != nullptr && oldSwapChain->swapChainImageFormat == swapChainImageFormat &&
+            oldSwapChain->swapChainDepthFormat == swapChainDepthFormat) {
+            // same formats, same render pass: take it over so pipelines built against it stay valid
+            renderPass = oldSwapChain->renderPass;
+            oldSwapChain->renderPass = VK_NULL_HANDLE;
+            return;
+        }
         VkAttachmentDescription depthAttachment{};
-        depthAttachment.format = findDepthFormat();
+        depthAttachment.format = swapChainDepthFormat;
         depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -190,7 +296,8 @@ namespace lvk {
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.finalLayout =
+                device.isHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
         VkAttachmentReference colorAttachmentRef = {};
         colorAttachmentRef.attachment = 0;
         colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -210,10 +317,10 @@ namespace lvk {
         dependency.dstStageMask =
                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
         dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.srcAccessMask = 0;
-        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        // a slot's depth image is reused by its next frame, so its depth writes must finish first
+        dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
         dependency.srcStageMask =
-                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
 
         std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
         VkRenderPassCreateInfo renderPassInfo = {};
@@ -229,9 +336,10 @@ namespace lvk {
         }
     }
     void LvkSwapChain::createFramebuffers() {
-        swapChainFramebuffers.resize(imageCount());
-        for (size_t i = 0; i < imageCount(); i++) {
-            std::array<VkImageView, 2> attachments = {swapChainImageViews[i], depthImageViews[i]};
+        const uint32_t frames = policy.framesInFlight;
+        swapChainFramebuffers.resize(imageCount() * frames);
+        for (size_t i = 0; i < swapChainFramebuffers.size(); i++) {
+            std::array<VkImageView, 2> attachments = {swapChainImageViews[i / frames], depthImageViews[i % frames]};
             VkExtent2D swapChainExtent = getSwapChainExtent();
             VkFramebufferCreateInfo framebufferInfo = {};
             framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
@@ -252,13 +360,15 @@ namespace lvk {
     }
 
     void LvkSwapChain::createDepthResources() {
-        VkFormat depthFormat = findDepthFormat();
-        swapChainDepthFormat = depthFormat;
+        // chosen by createRenderPass, which the render pass must agree with
+        VkFormat depthFormat = swapChainDepthFormat;
         VkExtent2D swapChainExtent = getSwapChainExtent();
 
-        depthImages.resize(imageCount());
-        depthImageMemorys.resize(imageCount());
-        depthImageViews.resize(imageCount());
+        depthImages.resize(policy.framesInFlight);
+        depthImageAllocations.resize(policy.framesInFlight);
+        depthImageViews.resize(policy.framesInFlight);
+        depthMemory_ = {};
+        depthMemory_.imageCount = policy.framesInFlight;
         for (int i = 0; i < depthImages.size(); i++) {
             VkImageCreateInfo imageInfo{};
             imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -271,15 +381,31 @@ namespace lvk {
             imageInfo.format = depthFormat;
             imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
             imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            // cleared on load and never stored, so the contents need not outlive the render pass
+            imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
             imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
             imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
             imageInfo.flags = 0;
-            device.createImageWithInfo(
-                    imageInfo,
-                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                    depthImages[i],
-                    depthImageMemorys[i]);
+            if (vkCreateImage(device.device(), &imageInfo, nullptr, &depthImages[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create depth image!");
+            }
+            VkMemoryRequirements memRequirements;
+            vkGetImageMemoryRequirements(device.device(), depthImages[i], &memRequirements);
+            VkMemoryPropertyFlags properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            if (device.allocator().hasMemoryType(
+                        memRequirements.memoryTypeBits, properties | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)) {
+                properties |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+                depthMemory_.lazilyAllocated = true;
+            }
+            depthImageAllocations[i] = device.allocator().allocate(memRequirements, properties, false);
+            if (vkBindImageMemory(
+                        device.device(),
+                        depthImages[i],
+                        depthImageAllocations[i].memory,
+                        depthImageAllocations[i].offset) != VK_SUCCESS) {
+                throw std::runtime_error("failed to bind depth image memory!");
+            }
+            depthMemory_.bytes += memRequirements.size;
             VkImageViewCreateInfo viewInfo{};
             viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
             viewInfo.image = depthImages[i];
@@ -294,23 +420,31 @@ namespace lvk {
                 throw std::runtime_error("failed to create texture image view!");
             }
         }
+        const VkDeviceSize perImageBytes = depthMemory_.bytes / depthMemory_.imageCount;
+        const VkDeviceSize perSwapImageBytes = perImageBytes * imageCount();
+        const VkDeviceSize committedBytes = depthMemory_.lazilyAllocated ? 0 : depthMemory_.bytes;
+        depthMemory_.bytesSaved = perSwapImageBytes > committedBytes ? perSwapImageBytes - committedBytes : 0;
+        // once per renderer, not on every resize; getDepthMemory() always has the current numbers
+        if (oldSwapChain == nullptr) {
+            std::cout << "Depth: " << depthMemory_.imageCount << " transient image(s), "
+                      << depthMemory_.bytes / (1024 * 1024) << " MiB"
+                      << (depthMemory_.lazilyAllocated ? " lazily allocated" : "") << ", "
+                      << depthMemory_.bytesSaved / (1024 * 1024) << " MiB saved" << std::endl;
+        }
     }
     void LvkSwapChain::createSyncObjects() {
-        imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+        imageAvailableSemaphores.resize(policy.framesInFlight);
+        renderFinishedSemaphores.resize(policy.framesInFlight);
+        // 0 is where the timeline starts, so it counts as already complete
+        frameValues.assign(policy.framesInFlight, 0);
+        imageValues.assign(imageCount(), 0);
         VkSemaphoreCreateInfo semaphoreInfo = {};
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-        VkFenceCreateInfo fenceInfo = {};
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+        for (size_t i = 0; i < policy.framesInFlight; i++) {
             if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
                 VK_SUCCESS ||
                 vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) !=
-                VK_SUCCESS ||
-                vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+                VK_SUCCESS) {
                 throw std::runtime_error("failed to create synchronization objects for a frame!");
             }
         }
@@ -327,19 +461,18 @@ namespace lvk {
     }
     VkPresentModeKHR LvkSwapChain::chooseSwapPresentMode(
             const std::vector<VkPresentModeKHR> &availablePresentModes) {
-        for (const auto &availablePresentMode : availablePresentModes) {
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                std::cout << "Present mode: Mailbox" << std::endl;
-                return availablePresentMode;
+        for (auto preferred : policy.presentModes) {
+            if (std::find(availablePresentModes.begin(), availablePresentModes.end(), preferred) !=
+                availablePresentModes.end()) {
+                std::cout << "Present mode: "
+                          << (preferred == VK_PRESENT_MODE_IMMEDIATE_KHR ? "Immediate"
+                              : preferred == VK_PRESENT_MODE_MAILBOX_KHR ? "Mailbox"
+                                                                          : "Other")
+                          << " (" << policy.name << ")" << std::endl;
+                return preferred;
             }
         }
-        // for (const auto &availablePresentMode : availablePresentModes) {
-        //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-        //     std::cout << "Present mode: Immediate" << std::endl;
-        //     return availablePresentMode;
-        //   }
-        // }
-        std::cout << "Present mode: V-Sync" << std::endl;
+        std::cout << "Present mode: V-Sync (" << policy.name << ")" << std::endl;
         return VK_PRESENT_MODE_FIFO_KHR;
     }
     VkExtent2D LvkSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities) {
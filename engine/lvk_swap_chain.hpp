@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lvk_device.hpp"
+#include "lvk_frame_policy.hpp"
 
 // vulkan headers
 #include <vulkan/vulkan.h>
@@ -14,21 +15,51 @@ namespace lvk {
 
 class LvkSwapChain {
  public:
-  static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-
-    LvkSwapChain(LvkDevice &deviceRef, VkExtent2D windowExtent);
+  // upper bound for per-frame arrays; the policy decides how many frames are actually in flight
+  static constexpr int MAX_FRAMES_IN_FLIGHT = LvkFramePolicy::MAX_FRAMES_IN_FLIGHT;
+
+  // CPU time spent inside the last acquireNextImage/submitCommandBuffers pair, in milliseconds.
+  struct FrameTimings {
+    double fenceWaitMs = 0.0;
+    double acquireMs = 0.0;
+    double submitMs = 0.0;
+    double presentMs = 0.0;
+  };
+
+    LvkSwapChain(LvkDevice &deviceRef, VkExtent2D windowExtent, const LvkFramePolicy &policy = {});
     LvkSwapChain(
-            LvkDevice &deviceRef, VkExtent2D windowExtent, std::shared_ptr<LvkSwapChain> previous);
+            LvkDevice &deviceRef,
+            VkExtent2D windowExtent,
+            std::shared_ptr<LvkSwapChain> previous,
+            const LvkFramePolicy &policy = {});
 
     ~LvkSwapChain();
 
+  // Depth is only needed while a frame renders, so there is one transient image per frame in flight
+  // rather than per swap chain image.
+  struct DepthMemory {
+    uint32_t imageCount = 0;
+    VkDeviceSize bytes = 0;
+    // backed on demand, typically by tile memory, so bytes may never be committed
+    bool lazilyAllocated = false;
+    // compared with one DEVICE_LOCAL depth image per swap chain image
+    VkDeviceSize bytesSaved = 0;
+  };
+
   LvkSwapChain(const LvkSwapChain &) = delete;
   LvkSwapChain &operator=(const LvkSwapChain &) = delete;
 
-  VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
+  // There is one framebuffer per (image, frame slot) pair, pairing the image with the slot's depth.
+  VkFramebuffer getFrameBuffer(int imageIndex, int frameIndex) {
+    return swapChainFramebuffers[imageIndex * policy.framesInFlight + frameIndex];
+  }
   VkRenderPass getRenderPass() { return renderPass; }
   VkImageView getImageView(int index) { return swapChainImageViews[index]; }
+  // In headless mode these are the offscreen color targets, left in TRANSFER_SRC_OPTIMAL.
+  VkImage getImage(int index) { return swapChainImages[index]; }
   size_t imageCount() { return swapChainImages.size(); }
+  uint32_t framesInFlight() const { return policy.framesInFlight; }
+  VkPresentModeKHR getPresentMode() const { return presentMode; }
   VkFormat getSwapChainImageFormat() { return swapChainImageFormat; }
   VkExtent2D getSwapChainExtent() { return swapChainExtent; }
   uint32_t width() { return swapChainExtent.width; }
@@ -39,8 +70,15 @@ class LvkSwapChain {
   }
   VkFormat findDepthFormat();
 
+  // Waits for the graphics timeline value of the frame that last used this frame slot.
   VkResult acquireNextImage(uint32_t *imageIndex);
-  VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
+  // uploadWait is the upload batch whose buffers the command buffer acquires, if any.
+  VkResult submitCommandBuffers(
+      const VkCommandBuffer *buffers, uint32_t *imageIndex, const LvkTimelineWait &uploadWait = {});
+  // Graphics timeline value signalled by the last submitCommandBuffers.
+  uint64_t lastSubmittedValue() const { return lastFrameValue; }
+  const FrameTimings &lastFrameTimings() const { return frameTimings; }
+  const DepthMemory &depthMemory() const { return depthMemory_; }
 
   bool compareSwapFormats(const LvkSwapChain& swapChain) const {
       return swapChain.swapChainDepthFormat == swapChainDepthFormat && swapChain.swapChainImageFormat == swapChainImageFormat;
@@ -49,6 +87,7 @@ class LvkSwapChain {
  private:
   void init();
   void createSwapChain();
+  void createOffscreenImages();
   void createImageViews();
   void createDepthResources();
   void createRenderPass();
@@ -70,22 +109,29 @@ class LvkSwapChain {
   VkRenderPass renderPass;
 
   std::vector<VkImage> depthImages;
-  std::vector<VkDeviceMemory> depthImageMemorys;
+  std::vector<LvkAllocation> depthImageAllocations;
   std::vector<VkImageView> depthImageViews;
   std::vector<VkImage> swapChainImages;
+  std::vector<LvkAllocation> offscreenImageAllocations;
   std::vector<VkImageView> swapChainImageViews;
 
   LvkDevice &device;
   VkExtent2D windowExtent;
+  LvkFramePolicy policy;
+  VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
 
-  VkSwapchainKHR swapChain;
+  VkSwapchainKHR swapChain = VK_NULL_HANDLE;
   std::shared_ptr<LvkSwapChain> oldSwapChain;
 
   std::vector<VkSemaphore> imageAvailableSemaphores;
   std::vector<VkSemaphore> renderFinishedSemaphores;
-  std::vector<VkFence> inFlightFences;
-  std::vector<VkFence> imagesInFlight;
+  // graphics timeline values of the last submission per frame slot and per image
+  std::vector<uint64_t> frameValues;
+  std::vector<uint64_t> imageValues;
+  uint64_t lastFrameValue = 0;
   size_t currentFrame = 0;
+  FrameTimings frameTimings{};
+  DepthMemory depthMemory_{};
 
 };
 
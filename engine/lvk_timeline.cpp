@@ -0,0 +1,114 @@
+#include "lvk_timeline.hpp"
+
+//std
+#include <array>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace lvk {
+
+    LvkTimeline::LvkTimeline(VkDevice device, VkQueue queue) : device{device}, queue{queue} {
+        VkSemaphoreTypeCreateInfo typeInfo{};
+        typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        typeInfo.initialValue = 0;
+        VkSemaphoreCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        createInfo.pNext = &typeInfo;
+        if (vkCreateSemaphore(device, &createInfo, nullptr, &timelineSemaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timeline semaphore!");
+        }
+    }
+
+    LvkTimeline::~LvkTimeline() {
+        vkDestroySemaphore(device, timelineSemaphore, nullptr);
+    }
+
+    uint64_t LvkTimeline::submit(const VkSubmitInfo &submitInfo, const LvkTimelineWait &wait) {
+        assert(submitInfo.signalSemaphoreCount < MAX_SEMAPHORES && submitInfo.waitSemaphoreCount < MAX_SEMAPHORES &&
+               "too many semaphores for one submission");
+        // values are ignored for binary semaphores, but the arrays must cover every semaphore
+        std::array<VkSemaphore, MAX_SEMAPHORES> waitSemaphores{};
+        std::array<VkPipelineStageFlags, MAX_SEMAPHORES> waitStages{};
+        std::array<uint64_t, MAX_SEMAPHORES> waitValues{};
+        uint32_t waitCount = submitInfo.waitSemaphoreCount;
+        for (uint32_t i = 0; i < waitCount; i++) {
+            waitSemaphores[i] = submitInfo.pWaitSemaphores[i];
+            waitStages[i] = submitInfo.pWaitDstStageMask[i];
+        }
+        if (wait.semaphore != VK_NULL_HANDLE) {
+            waitSemaphores[waitCount] = wait.semaphore;
+            waitStages[waitCount] = wait.stageMask;
+            waitValues[waitCount] = wait.value;
+            waitCount++;
+        }
+        std::array<VkSemaphore, MAX_SEMAPHORES> signalSemaphores{};
+        std::array<uint64_t, MAX_SEMAPHORES> signalValues{};
+        for (uint32_t i = 0; i < submitInfo.signalSemaphoreCount; i++) {
+            signalSemaphores[i] = submitInfo.pSignalSemaphores[i];
+        }
+        const uint32_t timelineIndex = submitInfo.signalSemaphoreCount;
+        signalSemaphores[timelineIndex] = timelineSemaphore;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.pNext = submitInfo.pNext;
+        timelineInfo.waitSemaphoreValueCount = waitCount;
+        timelineInfo.pWaitSemaphoreValues = waitValues.data();
+        timelineInfo.signalSemaphoreValueCount = timelineIndex + 1;
+        timelineInfo.pSignalSemaphoreValues = signalValues.data();
+
+        VkSubmitInfo timelineSubmit = submitInfo;
+        timelineSubmit.pNext = &timelineInfo;
+        timelineSubmit.waitSemaphoreCount = waitCount;
+        timelineSubmit.pWaitSemaphores = waitSemaphores.data();
+        timelineSubmit.pWaitDstStageMask = waitStages.data();
+        timelineSubmit.signalSemaphoreCount = timelineIndex + 1;
+        timelineSubmit.pSignalSemaphores = signalSemaphores.data();
+
+        std::lock_guard<std::mutex> lock{queueMutex};
+        const uint64_t value = submittedValue.load(std::memory_order_relaxed) + 1;
+        signalValues[timelineIndex] = value;
+        if (vkQueueSubmit(queue, 1, &timelineSubmit, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit to queue!");
+        }
+        submittedValue.store(value, std::memory_order_release);
+        return value;
+    }
+
+    uint64_t LvkTimeline::completedValue() {
+        uint64_t value = 0;
+        if (vkGetSemaphoreCounterValue(device, timelineSemaphore, &value) != VK_SUCCESS) {
+            throw std::runtime_error("failed to read timeline semaphore!");
+        }
+        noteCompleted(value);
+        return value;
+    }
+
+    void LvkTimeline::noteCompleted(uint64_t value) {
+        uint64_t known = knownCompleted.load(std::memory_order_relaxed);
+        while (value > known && !knownCompleted.compare_exchange_weak(known, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool LvkTimeline::isComplete(uint64_t value) {
+        return value <= knownCompleted.load(std::memory_order_relaxed) || value <= completedValue();
+    }
+
+    void LvkTimeline::wait(uint64_t value) {
+        if (isComplete(value)) {
+            return;
+        }
+        assert(value <= lastSubmittedValue() && "waiting for a value nothing will signal");
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timelineSemaphore;
+        waitInfo.pValues = &value;
+        if (vkWaitSemaphores(device, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to wait for timeline semaphore!");
+        }
+        noteCompleted(value);
+    }
+}
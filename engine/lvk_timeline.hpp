@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+//std
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace lvk {
+    // A point on another queue's timeline a submission must wait for, such as the upload batch
+    // that released buffers to this queue. A null semaphore waits for nothing.
+    struct LvkTimelineWait {
+        VkSemaphore semaphore = VK_NULL_HANDLE;
+        uint64_t value = 0;
+        VkPipelineStageFlags stageMask = 0;
+    };
+
+    // Timeline semaphore signalled by every submission to one queue, each with the next value, so a
+    // value names a submission and everything before it. Any thread can check how far the GPU has
+    // got, or wait for exactly the submission it needs, without a fence per submission. All
+    // submissions to the queue must go through submit() to keep the values in queue order.
+    class LvkTimeline {
+    public:
+        // most semaphores a submission may wait on or signal besides the timeline
+        static constexpr uint32_t MAX_SEMAPHORES = 8;
+
+        LvkTimeline(VkDevice device, VkQueue queue);
+        ~LvkTimeline();
+
+        LvkTimeline(const LvkTimeline &) = delete;
+        LvkTimeline &operator=(const LvkTimeline &) = delete;
+
+        // Submits one batch, additionally waiting for wait and signalling the returned value.
+        // Thread-safe. The batch may wait on and signal binary semaphores but must not chain a
+        // VkTimelineSemaphoreSubmitInfo.
+        uint64_t submit(const VkSubmitInfo &submitInfo, const LvkTimelineWait &wait = {});
+        // Hold this around other use of the queue that needs external sync, such as presenting.
+        std::unique_lock<std::mutex> lockQueue() { return std::unique_lock<std::mutex>{queueMutex}; }
+
+        VkSemaphore semaphore() const { return timelineSemaphore; }
+        uint64_t lastSubmittedValue() const { return submittedValue.load(std::memory_order_acquire); }
+        uint64_t completedValue();
+        bool isComplete(uint64_t value);
+        void wait(uint64_t value);
+
+    private:
+        void noteCompleted(uint64_t value);
+
+        VkDevice device;
+        VkQueue queue;
+        VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+        std::mutex queueMutex;
+        std::atomic<uint64_t> submittedValue{0};
+        // newest value seen complete, so isComplete rarely has to ask the driver
+        std::atomic<uint64_t> knownCompleted{0};
+    };
+}
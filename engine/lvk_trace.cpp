@@ -0,0 +1,159 @@
+#include "lvk_trace.hpp"
+
+//std
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lvk {
+
+    namespace {
+        struct Zone {
+            const char *name;
+            uint64_t beginNs;
+            uint64_t endNs;
+        };
+
+        // Written only by the owning thread; count is published with release so a reader sees
+        // fully written zones. Chunks are never freed or moved while the process runs.
+        struct Chunk {
+            static constexpr uint32_t CAPACITY = 4096;
+            Zone zones[CAPACITY];
+            std::atomic<uint32_t> count{0};
+            std::atomic<Chunk *> next{nullptr};
+        };
+
+        struct ThreadBuffer {
+            uint32_t threadId;
+            std::string name;
+            Chunk *head = nullptr;
+            Chunk *tail = nullptr;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>> threads;
+            std::vector<std::unique_ptr<Chunk>> chunks;
+            const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        };
+
+        Registry &registry() {
+            // leaked on purpose: threads may still trace while static destructors run
+            static Registry *instance = new Registry{};
+            return *instance;
+        }
+
+        Chunk *newChunk(Registry &reg) {
+            std::lock_guard<std::mutex> lock{reg.mutex};
+            reg.chunks.push_back(std::make_unique<Chunk>());
+            return reg.chunks.back().get();
+        }
+
+        thread_local ThreadBuffer *currentBuffer = nullptr;
+
+        ThreadBuffer &threadBuffer() {
+            if (currentBuffer == nullptr) {
+                Registry &reg = registry();
+                Chunk *chunk = newChunk(reg);
+                std::lock_guard<std::mutex> lock{reg.mutex};
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->threadId = static_cast<uint32_t>(reg.threads.size() + 1);
+                buffer->head = chunk;
+                buffer->tail = chunk;
+                currentBuffer = buffer.get();
+                reg.threads.push_back(std::move(buffer));
+            }
+            return *currentBuffer;
+        }
+
+        void writeEscaped(std::ostream &out, const char *text) {
+            for (const char *c = text; *c != '\0'; c++) {
+                if (*c == '"' || *c == '\\') out << '\\';
+                out << *c;
+            }
+        }
+    }
+
+    uint64_t LvkTrace::nowNs() {
+        auto elapsed = std::chrono::steady_clock::now() - registry().epoch;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    void LvkTrace::addZone(const char *name, uint64_t beginNs, uint64_t endNs) {
+        ThreadBuffer &buffer = threadBuffer();
+        Chunk *chunk = buffer.tail;
+        uint32_t index = chunk->count.load(std::memory_order_relaxed);
+        if (index == Chunk::CAPACITY) {
+            Chunk *next = newChunk(registry());
+            chunk->next.store(next, std::memory_order_release);
+            buffer.tail = next;
+            chunk = next;
+            index = 0;
+        }
+        chunk->zones[index] = Zone{name, beginNs, endNs};
+        chunk->count.store(index + 1, std::memory_order_release);
+    }
+
+    void LvkTrace::setThreadName(const char *name) {
+        ThreadBuffer &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock{registry().mutex};
+        buffer.name = name;
+    }
+
+    void LvkTrace::writeChromeTrace(std::ostream &out) {
+        Registry &reg = registry();
+        std::vector<ThreadBuffer *> threads;
+        bool first = true;
+        {
+            std::lock_guard<std::mutex> lock{reg.mutex};
+            for (auto &thread : reg.threads) {
+                threads.push_back(thread.get());
+            }
+            out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+            for (auto *thread : threads) {
+                if (thread->name.empty()) continue;
+                out << (first ? "  " : ",\n  ");
+                first = false;
+                out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->threadId
+                    << ", \"args\": {\"name\": \"";
+                writeEscaped(out, thread->name.c_str());
+                out << "\"}}";
+            }
+        }
+        // zones are read without the lock, so tracing threads are never held up by a dump
+        for (auto *thread : threads) {
+            for (Chunk *chunk = thread->head; chunk != nullptr; chunk = chunk->next.load(std::memory_order_acquire)) {
+                const uint32_t count = chunk->count.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < count; i++) {
+                    const Zone &zone = chunk->zones[i];
+                    out << (first ? "  " : ",\n  ");
+                    first = false;
+                    out << "{\"name\": \"";
+                    writeEscaped(out, zone.name);
+                    out << "\", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread->threadId
+                        << ", \"ts\": " << static_cast<double>(zone.beginNs) * 1e-3
+                        << ", \"dur\": " << static_cast<double>(zone.endNs - zone.beginNs) * 1e-3 << "}";
+                }
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    bool LvkTrace::writeChromeTraceFromEnv() {
+        const char *path = std::getenv(FILE_ENV);
+        if (path == nullptr || *path == '\0') {
+            return false;
+        }
+        std::ofstream out{path};
+        if (!out.is_open()) {
+            return false;
+        }
+        writeChromeTrace(out);
+        return true;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+//std
+#include <cstdint>
+#include <ostream>
+
+namespace lvk {
+
+    // CPU zone tracing, compiled in with the LVK_ENABLE_TRACING CMake option. Every thread appends
+    // completed zones to its own chunked buffer without locking; only the first event of a thread
+    // and chunk allocation take a lock. Buffers outlive their threads, so a dump sees every zone
+    // recorded so far, including those of job workers that have already exited.
+    class LvkTrace {
+    public:
+        static constexpr bool ENABLED =
+#ifdef LVK_ENABLE_TRACING
+                true;
+#else
+                false;
+#endif
+        // Name of the environment variable that makes App::run dump a trace on exit.
+        static constexpr const char *FILE_ENV = "LVK_TRACE_FILE";
+
+        static uint64_t nowNs();
+        // name must outlive the trace; string literals are the intended use.
+        static void addZone(const char *name, uint64_t beginNs, uint64_t endNs);
+        static void setThreadName(const char *name);
+        // Chrome trace event JSON, viewable in chrome://tracing or ui.perfetto.dev.
+        static void writeChromeTrace(std::ostream &out);
+        // Writes to the file named by FILE_ENV, if set. Returns false if it is not set or cannot be opened.
+        static bool writeChromeTraceFromEnv();
+    };
+
+    class LvkTraceZone {
+    public:
+        explicit LvkTraceZone(const char *name) : name{name}, beginNs{LvkTrace::nowNs()} {}
+        ~LvkTraceZone() { LvkTrace::addZone(name, beginNs, LvkTrace::nowNs()); }
+
+        LvkTraceZone(const LvkTraceZone &) = delete;
+        LvkTraceZone &operator=(const LvkTraceZone &) = delete;
+
+    private:
+        const char *name;
+        uint64_t beginNs;
+    };
+}
+
+#ifdef LVK_ENABLE_TRACING
+#define LVK_TRACE_CONCAT_IMPL(a, b) a##b
+#define LVK_TRACE_CONCAT(a, b) LVK_TRACE_CONCAT_IMPL(a, b)
+#define LVK_TRACE_ZONE(name) ::lvk::LvkTraceZone LVK_TRACE_CONCAT(lvkTraceZone, __LINE__){name}
+#define LVK_TRACE_THREAD_NAME(name) ::lvk::LvkTrace::setThreadName(name)
+#else
+#define LVK_TRACE_ZONE(name) ((void)0)
+#define LVK_TRACE_THREAD_NAME(name) ((void)0)
+#endif
@@ -0,0 +1,257 @@
+#include "lvk_transform_kernel.hpp"
+
+//std
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LVK_TRANSFORM_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LVK_TARGET_AVX2
+#else
+#define LVK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace lvk {
+
+    namespace {
+        using TransformKernel = void (*)(const float *, const float *, uint8_t *, float *, size_t, size_t);
+
+        void transformScalar(const float *scales, const float *rotations, uint8_t *dirty, float *out,
+                             size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (dirty != nullptr) {
+                    if (dirty[i] == 0) continue;
+                    dirty[i] = 0;
+                }
+                const float s = std::sin(rotations[i]);
+                const float c = std::cos(rotations[i]);
+                const float sx = scales[2 * i];
+                const float sy = scales[2 * i + 1];
+                out[4 * i + 0] = c * sx;
+                out[4 * i + 1] = s * sx;
+                out[4 * i + 2] = -s * sy;
+                out[4 * i + 3] = c * sy;
+            }
+        }
+
+        // True if any of the count dirty bytes starting at i is set; clears them.
+        bool takeDirty(uint8_t *dirty, size_t i, size_t count) {
+            if (dirty == nullptr) {
+                return true;
+            }
+            uint64_t bits = 0;
+            memcpy(&bits, dirty + i, count);
+            if (bits == 0) {
+                return false;
+            }
+            memset(dirty + i, 0, count);
+            return true;
+        }
+
+#ifdef LVK_TRANSFORM_X86
+        // Cephes-style sincos: reduce to [-pi/4, pi/4] by octant, then evaluate both minimax
+        // polynomials and select per lane. Max error is a few ulp over the range rotations use.
+        constexpr float FOUR_OVER_PI = 1.27323954473516f;
+        constexpr float DP1 = -0.78515625f;
+        constexpr float DP2 = -2.4187564849853515625e-4f;
+        constexpr float DP3 = -3.77489497744594108e-8f;
+        constexpr float SIN_P0 = -1.9515295891e-4f;
+        constexpr float SIN_P1 = 8.3321608736e-3f;
+        constexpr float SIN_P2 = -1.6666654611e-1f;
+        constexpr float COS_P0 = 2.443315711809948e-5f;
+        constexpr float COS_P1 = -1.388731625493765e-3f;
+        constexpr float COS_P2 = 4.166664568298827e-2f;
+
+        void sincosSse(__m128 x, __m128 &outSin, __m128 &outCos) {
+            const __m128 signMask = _mm_set1_ps(-0.f);
+            __m128 signSin = _mm_and_ps(x, signMask);
+            x = _mm_andnot_ps(signMask, x);
+
+            __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+            octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+            __m128 y = _mm_cvtepi32_ps(octant);
+
+            __m128 swapSignSin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+            __m128 polyMask = _mm_castsi128_ps(
+                    _mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+            __m128 signCos = _mm_castsi128_ps(_mm_slli_epi32(
+                    _mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+            signSin = _mm_xor_ps(signSin, swapSignSin);
+
+            x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+            x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+            x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+            __m128 z = _mm_mul_ps(x, x);
+
+            __m128 yCos = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+            yCos = _mm_add_ps(_mm_mul_ps(yCos, z), _mm_set1_ps(COS_P2));
+            yCos = _mm_mul_ps(_mm_mul_ps(yCos, z), z);
+            yCos = _mm_sub_ps(yCos, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+            yCos = _mm_add_ps(yCos, _mm_set1_ps(1.f));
+
+            __m128 ySin = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+            ySin = _mm_add_ps(_mm_mul_ps(ySin, z), _mm_set1_ps(SIN_P2));
+            ySin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ySin, z), x), x);
+
+            __m128 s = _mm_or_ps(_mm_and_ps(polyMask, ySin), _mm_andnot_ps(polyMask, yCos));
+            __m128 c = _mm_or_ps(_mm_and_ps(polyMask, yCos), _mm_andnot_ps(polyMask, ySin));
+            outSin = _mm_xor_ps(s, signSin);
+            outCos = _mm_xor_ps(c, signCos);
+        }
+
+        void transformSse2(const float *scales, const float *rotations, uint8_t *dirty, float *out,
+                           size_t begin, size_t end) {
+            size_t i = begin;
+            for (; i + 4 <= end; i += 4) {
+                if (!takeDirty(dirty, i, 4)) continue;
+                __m128 s, c;
+                sincosSse(_mm_loadu_ps(rotations + i), s, c);
+                __m128 scale01 = _mm_loadu_ps(scales + 2 * i);
+                __m128 scale23 = _mm_loadu_ps(scales + 2 * i + 4);
+                __m128 sx = _mm_shuffle_ps(scale01, scale23, _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 sy = _mm_shuffle_ps(scale01, scale23, _MM_SHUFFLE(3, 1, 3, 1));
+
+                __m128 m0 = _mm_mul_ps(c, sx);
+                __m128 m1 = _mm_mul_ps(s, sx);
+                __m128 m2 = _mm_xor_ps(_mm_mul_ps(s, sy), _mm_set1_ps(-0.f));
+                __m128 m3 = _mm_mul_ps(c, sy);
+                _MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+                _mm_storeu_ps(out + 4 * i, m0);
+                _mm_storeu_ps(out + 4 * i + 4, m1);
+                _mm_storeu_ps(out + 4 * i + 8, m2);
+                _mm_storeu_ps(out + 4 * i + 12, m3);
+            }
+            transformScalar(scales, rotations, dirty, out, i, end);
+        }
+
+        LVK_TARGET_AVX2 void sincosAvx2(__m256 x, __m256 &outSin, __m256 &outCos) {
+            const __m256 signMask = _mm256_set1_ps(-0.f);
+            __m256 signSin = _mm256_and_ps(x, signMask);
+            x = _mm256_andnot_ps(signMask, x);
+
+            __m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+            octant = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+            __m256 y = _mm256_cvtepi32_ps(octant);
+
+            __m256 swapSignSin = _mm256_castsi256_ps(
+                    _mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+            __m256 polyMask = _mm256_castsi256_ps(
+                    _mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+            __m256 signCos = _mm256_castsi256_ps(_mm256_slli_epi32(
+                    _mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)), _mm256_set1_epi32(4)), 29));
+            signSin = _mm256_xor_ps(signSin, swapSignSin);
+
+            x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP1)));
+            x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP2)));
+            x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP3)));
+            __m256 z = _mm256_mul_ps(x, x);
+
+            __m256 yCos = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_P0), z), _mm256_set1_ps(COS_P1));
+            yCos = _mm256_add_ps(_mm256_mul_ps(yCos, z), _mm256_set1_ps(COS_P2));
+            yCos = _mm256_mul_ps(_mm256_mul_ps(yCos, z), z);
+            yCos = _mm256_sub_ps(yCos, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+            yCos = _mm256_add_ps(yCos, _mm256_set1_ps(1.f));
+
+            __m256 ySin = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_P0), z), _mm256_set1_ps(SIN_P1));
+            ySin = _mm256_add_ps(_mm256_mul_ps(ySin, z), _mm256_set1_ps(SIN_P2));
+            ySin = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ySin, z), x), x);
+
+            outSin = _mm256_xor_ps(_mm256_blendv_ps(yCos, ySin, polyMask), signSin);
+            outCos = _mm256_xor_ps(_mm256_blendv_ps(ySin, yCos, polyMask), signCos);
+        }
+
+        LVK_TARGET_AVX2 void transformAvx2(const float *scales, const float *rotations, uint8_t *dirty, float *out,
+                                           size_t begin, size_t end) {
+            size_t i = begin;
+            for (; i + 8 <= end; i += 8) {
+                if (!takeDirty(dirty, i, 8)) continue;
+                __m256 s, c;
+                sincosAvx2(_mm256_loadu_ps(rotations + i), s, c);
+
+                // deinterleave (x, y) pairs; the shuffle works per 128-bit lane, the permute restores order
+                __m256 scale0 = _mm256_loadu_ps(scales + 2 * i);
+                __m256 scale1 = _mm256_loadu_ps(scales + 2 * i + 8);
+                __m256 sx = _mm256_shuffle_ps(scale0, scale1, _MM_SHUFFLE(2, 0, 2, 0));
+                __m256 sy = _mm256_shuffle_ps(scale0, scale1, _MM_SHUFFLE(3, 1, 3, 1));
+                sx = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sx), _MM_SHUFFLE(3, 1, 2, 0)));
+                sy = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sy), _MM_SHUFFLE(3, 1, 2, 0)));
+
+                __m256 m0 = _mm256_mul_ps(c, sx);
+                __m256 m1 = _mm256_mul_ps(s, sx);
+                __m256 m2 = _mm256_xor_ps(_mm256_mul_ps(s, sy), _mm256_set1_ps(-0.f));
+                __m256 m3 = _mm256_mul_ps(c, sy);
+
+                // 4x8 transpose into one (m0, m1, m2, m3) quad per object
+                __m256 t0 = _mm256_unpacklo_ps(m0, m1);
+                __m256 t1 = _mm256_unpackhi_ps(m0, m1);
+                __m256 t2 = _mm256_unpacklo_ps(m2, m3);
+                __m256 t3 = _mm256_unpackhi_ps(m2, m3);
+                __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+                _mm256_storeu_ps(out + 4 * i, _mm256_permute2f128_ps(u0, u1, 0x20));
+                _mm256_storeu_ps(out + 4 * i + 8, _mm256_permute2f128_ps(u2, u3, 0x20));
+                _mm256_storeu_ps(out + 4 * i + 16, _mm256_permute2f128_ps(u0, u1, 0x31));
+                _mm256_storeu_ps(out + 4 * i + 24, _mm256_permute2f128_ps(u2, u3, 0x31));
+            }
+            transformSse2(scales, rotations, dirty, out, i, end);
+        }
+
+        bool cpuSupportsAvx2() {
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) return false;
+            __cpuidex(info, 7, 0);
+            bool avx2 = (info[1] & (1 << 5)) != 0;
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            // the OS must also save the upper halves of the ymm registers
+            return avx2 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        bool cpuSupportsSse2() {
+#if defined(_MSC_VER) || defined(__x86_64__)
+            return true;
+#else
+            return __builtin_cpu_supports("sse2");
+#endif
+        }
+#endif
+
+        struct KernelChoice {
+            TransformKernel kernel;
+            const char *name;
+        };
+
+        KernelChoice selectKernel() {
+#ifdef LVK_TRANSFORM_X86
+            if (cpuSupportsAvx2()) return {transformAvx2, "avx2"};
+            if (cpuSupportsSse2()) return {transformSse2, "sse2"};
+#endif
+            return {transformScalar, "scalar"};
+        }
+
+        const KernelChoice &kernelChoice() {
+            static const KernelChoice choice = selectKernel();
+            return choice;
+        }
+    }
+
+    void computeTransforms2d(
+            const float *scales, const float *rotations, uint8_t *dirty, float *outMatrices, size_t count) {
+        kernelChoice().kernel(scales, rotations, dirty, outMatrices, 0, count);
+    }
+
+    const char *transformKernelName() {
+        return kernelChoice().name;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+//std
+#include <cstddef>
+#include <cstdint>
+
+namespace lvk {
+
+    // Batched Transform2dComponent::mat2() for structure-of-arrays data. For each object i, writes
+    // the columns of rotation * scale as (c*sx, s*sx, -s*sy, c*sy) to outMatrices[4*i .. 4*i+3],
+    // which is the layout the instanced vertex shader reads. scales holds interleaved (x, y) pairs.
+    //
+    // When dirty is non-null, blocks of objects whose dirty bytes are all zero are skipped and keep
+    // their previous output; every dirty byte that was processed is cleared.
+    //
+    // Picks AVX2, SSE2 or scalar code once at startup based on the CPU it is running on.
+    void computeTransforms2d(
+            const float *scales, const float *rotations, uint8_t *dirty, float *outMatrices, size_t count);
+
+    // "avx2", "sse2" or "scalar"
+    const char *transformKernelName();
+}
@@ -0,0 +1,338 @@
+#include "lvk_upload_queue.hpp"
+#include "lvk_device.hpp"
+#include "lvk_trace.hpp"
+
+//std
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace lvk {
+
+    namespace {
+        constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    LvkUploadQueue::LvkUploadQueue(LvkDevice &device, VkDeviceSize stagingSize)
+            : lvkDevice{device},
+              timeline{device.transferTimeline()},
+              dedicatedTransfer{device.findPhysicalQueueFamilies().hasDedicatedTransfer()},
+              profiler{device, device.findPhysicalQueueFamilies().transferFamily, "upload", PROFILER_SLOTS, 1} {
+        auto indices = device.findPhysicalQueueFamilies();
+        transferFamily = indices.transferFamily;
+        graphicsFamily = indices.graphicsFamily;
+        createStagingBuffer(stagingSize);
+    }
+
+    LvkUploadQueue::~LvkUploadQueue() {
+        waitIdle();
+        if (recording) {
+            destroyBatch(current);
+        }
+        for (auto &batch : freeBatches) {
+            destroyBatch(batch);
+        }
+        vkDestroyBuffer(lvkDevice.device(), stagingBuffer, nullptr);
+        lvkDevice.allocator().free(stagingAllocation);
+    }
+
+    void LvkUploadQueue::createStagingBuffer(VkDeviceSize size) {
+        stagingSize = size;
+        lvkDevice.createBuffer(
+                size,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                stagingBuffer,
+                stagingAllocation);
+    }
+
+    LvkUploadTicket LvkUploadQueue::enqueueBufferUpload(
+            VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size) {
+        if (size == 0) {
+            // nothing to copy, and an ownership transfer of 0 bytes is invalid
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!recording) {
+            beginRecording();
+        }
+        // uploads larger than a quarter of the ring are streamed through it in pieces
+        const VkDeviceSize chunkLimit = stagingSize / 4;
+        const char *src = static_cast<const char *>(data);
+        VkDeviceSize copied = 0;
+        while (copied < size) {
+            VkDeviceSize chunk = std::min(size - copied, chunkLimit);
+            VkDeviceSize offset = allocateStaging(chunk);
+            memcpy(static_cast<char *>(stagingAllocation.mapped) + offset, src + copied, static_cast<size_t>(chunk));
+
+            VkBufferCopy copyRegion{};
+            copyRegion.srcOffset = offset;
+            copyRegion.dstOffset = dstOffset + copied;
+            copyRegion.size = chunk;
+            vkCmdCopyBuffer(current.commandBuffer, stagingBuffer, dstBuffer, 1, &copyRegion);
+            recordingHasData = true;
+            copied += chunk;
+        }
+        if (dedicatedTransfer) {
+            // copies split across batches are all ordered before this release on the transfer queue
+            VkBufferMemoryBarrier release{};
+            release.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            release.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            release.dstAccessMask = 0;
+            release.srcQueueFamilyIndex = transferFamily;
+            release.dstQueueFamilyIndex = graphicsFamily;
+            release.buffer = dstBuffer;
+            release.offset = dstOffset;
+            release.size = size;
+            releases.push_back(release);
+        }
+        return current.ticket;
+    }
+
+    void LvkUploadQueue::flush() {
+        LVK_TRACE_ZONE("uploadFlush");
+        std::lock_guard<std::mutex> lock{mutex};
+        retireCompleted();
+        if (recording && recordingHasData) {
+            submitRecording();
+        }
+    }
+
+    bool LvkUploadQueue::isComplete(LvkUploadTicket ticket) {
+        if (dedicatedTransfer) {
+            // the acquiring frame waits for the copies on the GPU, so they need not have finished yet
+            return ticket <= acquiredTicket.load(std::memory_order_acquire);
+        }
+        if (ticket <= completedTicket.load(std::memory_order_acquire)) {
+            return true;
+        }
+        std::lock_guard<std::mutex> lock{mutex};
+        retireCompleted();
+        return ticket <= completedTicket.load(std::memory_order_relaxed);
+    }
+
+    void LvkUploadQueue::wait(LvkUploadTicket ticket) {
+        if (ticket <= completedTicket.load(std::memory_order_acquire)) {
+            return;
+        }
+        LVK_TRACE_ZONE("uploadWait");
+        std::lock_guard<std::mutex> lock{mutex};
+        if (recording && recordingHasData && current.ticket <= ticket) {
+            submitRecording();
+        }
+        while (ticket > completedTicket.load(std::memory_order_relaxed) && !inFlight.empty()) {
+            retireOldest();
+        }
+    }
+
+    void LvkUploadQueue::waitIdle() {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (recording && recordingHasData) {
+            submitRecording();
+        }
+        while (!inFlight.empty()) {
+            retireOldest();
+        }
+    }
+
+    LvkTimelineWait LvkUploadQueue::recordAcquires(VkCommandBuffer commandBuffer) {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (pendingAcquires.empty()) {
+            return {};
+        }
+        std::vector<VkBufferMemoryBarrier> barriers;
+        barriers.reserve(pendingAcquires.size());
+        LvkTimelineWait wait{timeline.semaphore(), 0, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT};
+        LvkUploadTicket ticket = 0;
+        for (const auto &acquire : pendingAcquires) {
+            barriers.push_back(acquire.barrier);
+            wait.value = std::max(wait.value, acquire.timelineValue);
+            ticket = std::max(ticket, acquire.ticket);
+        }
+        // the source stage matches the semaphore wait's, so the acquire happens after the release
+        vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                0,
+                0, nullptr,
+                static_cast<uint32_t>(barriers.size()), barriers.data(),
+                0, nullptr);
+        pendingAcquires.clear();
+        acquiredTicket.store(ticket, std::memory_order_release);
+        return wait;
+    }
+
+    void LvkUploadQueue::cancelAcquires(VkBuffer buffer) {
+        std::lock_guard<std::mutex> lock{mutex};
+        pendingAcquires.erase(
+                std::remove_if(pendingAcquires.begin(), pendingAcquires.end(),
+                               [buffer](const PendingAcquire &acquire) { return acquire.barrier.buffer == buffer; }),
+                pendingAcquires.end());
+        releases.erase(
+                std::remove_if(releases.begin(), releases.end(),
+                               [buffer](const VkBufferMemoryBarrier &release) { return release.buffer == buffer; }),
+                releases.end());
+    }
+
+    LvkUploadQueue::Batch LvkUploadQueue::acquireBatch() {
+        if (!freeBatches.empty()) {
+            Batch batch = freeBatches.back();
+            freeBatches.pop_back();
+            return batch;
+        }
+        Batch batch{};
+        VkCommandPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        poolInfo.queueFamilyIndex = transferFamily;
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        if (vkCreateCommandPool(lvkDevice.device(), &poolInfo, nullptr, &batch.commandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool = batch.commandPool;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(lvkDevice.device(), &allocInfo, &batch.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+        }
+        return batch;
+    }
+
+    void LvkUploadQueue::beginRecording() {
+        current = acquireBatch();
+        current.ticket = nextTicket++;
+        current.ringEnd = ringHead;
+        // a recycled batch has retired, so its pool can be reset in one go
+        vkResetCommandPool(lvkDevice.device(), current.commandPool, 0);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        if (vkBeginCommandBuffer(current.commandBuffer, &beginInfo) != VK_SUCCESS) {
+            throw std::runtime_error("failed to begin upload command buffer!");
+        }
+        // batch N reuses the profiler slot of batch N - PROFILER_SLOTS; skip timing it if that one is still in flight
+        current.profileScope = LvkGpuProfiler::INVALID_SCOPE;
+        if (!dedicatedTransfer && current.ticket <= completedTicket.load(std::memory_order_relaxed) + PROFILER_SLOTS) {
+            profiler.beginSlot(current.commandBuffer, static_cast<uint32_t>(current.ticket % PROFILER_SLOTS));
+            current.profileScope = profiler.beginScope(current.commandBuffer, "upload");
+        }
+        recording = true;
+        recordingHasData = false;
+    }
+
+    void LvkUploadQueue::submitRecording() {
+        if (dedicatedTransfer) {
+            if (!releases.empty()) {
+                vkCmdPipelineBarrier(
+                        current.commandBuffer,
+                        VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        0,
+                        0, nullptr,
+                        static_cast<uint32_t>(releases.size()), releases.data(),
+                        0, nullptr);
+            }
+        } else {
+            // later submissions on the queue may read the data as vertex/index input
+            VkMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            vkCmdPipelineBarrier(
+                    current.commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                    0,
+                    1, &barrier,
+                    0, nullptr,
+                    0, nullptr);
+        }
+        profiler.endScope(current.commandBuffer, current.profileScope);
+        if (vkEndCommandBuffer(current.commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record upload command buffer!");
+        }
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &current.commandBuffer;
+        current.timelineValue = timeline.submit(submitInfo);
+        for (const auto &release : releases) {
+            // the acquire repeats the release with the destination's access mask
+            VkBufferMemoryBarrier acquire = release;
+            acquire.srcAccessMask = 0;
+            acquire.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            pendingAcquires.push_back({acquire, current.timelineValue, current.ticket});
+        }
+        releases.clear();
+        inFlight.push_back(current);
+        recording = false;
+        recordingHasData = false;
+    }
+
+    VkDeviceSize LvkUploadQueue::allocateStaging(VkDeviceSize size) {
+        VkDeviceSize offset = 0;
+        while (!tryAllocateStaging(size, offset)) {
+            if (!inFlight.empty()) {
+                retireOldest();
+            } else {
+                // the batch being recorded fills the ring on its own, push it out and start another
+                submitRecording();
+                beginRecording();
+            }
+        }
+        return offset;
+    }
+
+    bool LvkUploadQueue::tryAllocateStaging(VkDeviceSize size, VkDeviceSize &offset) {
+        if (inFlight.empty() && !recordingHasData) {
+            ringHead = 0;
+            ringTail = 0;
+        }
+        const bool empty = ringHead == ringTail;
+        VkDeviceSize start = alignUp(ringHead, STAGING_ALIGNMENT);
+        if (empty) {
+            start = 0;
+        } else if (ringTail < ringHead) {
+            // live data sits in [tail, head), free space at the end and in front of tail
+            if (start + size > stagingSize) {
+                if (size >= ringTail) return false;
+                start = 0;
+            }
+        } else if (start + size >= ringTail) {
+            // wrapped: only [head, tail) is free; never let head catch up with tail
+            return false;
+        }
+        offset = start;
+        ringHead = start + size;
+        current.ringEnd = ringHead;
+        return true;
+    }
+
+    void LvkUploadQueue::retireCompleted() {
+        while (!inFlight.empty() && timeline.isComplete(inFlight.front().timelineValue)) {
+            retireOldest();
+        }
+    }
+
+    void LvkUploadQueue::retireOldest() {
+        Batch batch = inFlight.front();
+        inFlight.pop_front();
+        timeline.wait(batch.timelineValue);
+        ringTail = batch.ringEnd;
+        completedTicket.store(batch.ticket, std::memory_order_release);
+        freeBatches.push_back(batch);
+    }
+
+    void LvkUploadQueue::destroyBatch(Batch &batch) {
+        // frees the batch's command buffer along with the pool
+        vkDestroyCommandPool(lvkDevice.device(), batch.commandPool, nullptr);
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "lvk_allocator.hpp"
+#include "lvk_gpu_profiler.hpp"
+#include "lvk_timeline.hpp"
+
+//std
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace lvk {
+    class LvkDevice;
+
+    // Identifies the batch an upload was recorded into. Tickets increase monotonically, so an
+    // upload is complete once every batch up to and including its ticket has retired.
+    using LvkUploadTicket = uint64_t;
+
+    // Streams data into DEVICE_LOCAL buffers through a persistent, ring-allocated staging buffer.
+    // Uploads are recorded into the current batch and submitted together by flush(); each batch is
+    // tracked by the transfer timeline value it signals, so nothing here waits on the whole queue.
+    //
+    // With a dedicated transfer queue the copies overlap rendering. Each batch releases its buffers
+    // to the graphics family, and the next frame acquires them through recordAcquires() and waits
+    // for the batch on the GPU rather than on the CPU.
+    class LvkUploadQueue {
+    public:
+        static constexpr VkDeviceSize DEFAULT_STAGING_SIZE = 32ull * 1024 * 1024;
+
+        LvkUploadQueue(LvkDevice &device, VkDeviceSize stagingSize = DEFAULT_STAGING_SIZE);
+        ~LvkUploadQueue();
+
+        LvkUploadQueue(const LvkUploadQueue &) = delete;
+        LvkUploadQueue &operator=(const LvkUploadQueue &) = delete;
+
+        // Copies data into staging memory right away; the GPU copy runs after the next flush().
+        // A zero-size upload records nothing and returns ticket 0, which is always complete.
+        LvkUploadTicket enqueueBufferUpload(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+        // Submits everything recorded since the last flush. Cheap when nothing is pending.
+        void flush();
+        // True once graphics-queue commands recorded from now on may read the upload: its copies
+        // have finished, or with a dedicated transfer queue, a frame has acquired its buffers.
+        bool isComplete(LvkUploadTicket ticket);
+        // Blocks until the copies themselves have finished on the transfer queue.
+        void wait(LvkUploadTicket ticket);
+        void waitIdle();
+
+        // Records the ownership acquire of every submitted upload not yet acquired into a graphics
+        // command buffer, and returns the wait its submission must carry. Returns a null wait when
+        // there is nothing to acquire, which is always the case without a dedicated transfer queue.
+        LvkTimelineWait recordAcquires(VkCommandBuffer commandBuffer);
+        // Drops pending acquires of a buffer about to be destroyed before any frame acquired it.
+        void cancelAcquires(VkBuffer buffer);
+
+        // Times each batch's copies as an "upload" scope. Transfer-only queues cannot reset query
+        // pools, so nothing is recorded with a dedicated transfer queue.
+        LvkGpuProfiler &gpuProfiler() { return profiler; }
+
+    private:
+        static constexpr uint32_t PROFILER_SLOTS = 8;
+
+        // each batch owns a transient pool, reset wholesale before the batch is recorded again
+        struct Batch {
+            VkCommandPool commandPool = VK_NULL_HANDLE;
+            VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+            uint64_t timelineValue = 0;
+            LvkUploadTicket ticket = 0;
+            VkDeviceSize ringEnd = 0;
+            uint32_t profileScope = LvkGpuProfiler::INVALID_SCOPE;
+        };
+
+        struct PendingAcquire {
+            VkBufferMemoryBarrier barrier;
+            uint64_t timelineValue;
+            LvkUploadTicket ticket;
+        };
+
+        void createStagingBuffer(VkDeviceSize size);
+        Batch acquireBatch();
+        void beginRecording();
+        void submitRecording();
+        VkDeviceSize allocateStaging(VkDeviceSize size);
+        bool tryAllocateStaging(VkDeviceSize size, VkDeviceSize &offset);
+        void retireCompleted();
+        void retireOldest();
+        void destroyBatch(Batch &batch);
+
+        LvkDevice &lvkDevice;
+        LvkTimeline &timeline;
+        const bool dedicatedTransfer;
+        uint32_t transferFamily;
+        uint32_t graphicsFamily;
+
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;
+        LvkAllocation stagingAllocation;
+        VkDeviceSize stagingSize = 0;
+        VkDeviceSize ringHead = 0;
+        VkDeviceSize ringTail = 0;
+
+        bool recording = false;
+        bool recordingHasData = false;
+        Batch current;
+        std::deque<Batch> inFlight;
+        std::vector<Batch> freeBatches;
+        // ownership releases recorded at the end of the current batch, one per upload
+        std::vector<VkBufferMemoryBarrier> releases;
+        std::vector<PendingAcquire> pendingAcquires;
+
+        LvkUploadTicket nextTicket = 1;
+        std::atomic<LvkUploadTicket> completedTicket{0};
+        std::atomic<LvkUploadTicket> acquiredTicket{0};
+        std::mutex mutex;
+        LvkGpuProfiler profiler;
+    };
+}
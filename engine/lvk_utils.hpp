@@ -0,0 +1,27 @@
+#pragma once
+
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace lvk {
+
+    // from: https://stackoverflow.com/a/57595105
+    template <typename T, typename... Rest>
+    void hashCombine(std::size_t &seed, const T &v, const Rest &... rest) {
+        seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        (hashCombine(seed, rest), ...);
+    }
+
+    // Sibling of path to write before renaming it over path. Unique per thread (and, through the
+    // random part, per process), so concurrent writers of the same file never share a temp file.
+    inline std::string uniqueTempPath(const std::string &path) {
+        thread_local const std::size_t suffix = [] {
+            std::size_t seed = std::random_device{}();
+            hashCombine(seed, std::this_thread::get_id());
+            return seed;
+        }();
+        return path + ".tmp." + std::to_string(suffix);
+    }
+}
@@ -20,6 +20,13 @@ namespace lvk {
         glfwSetWindowUserPointer(window, this);
         glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
     }
+    void LvkWindow::pollEvents() {
+        if (isMinimized()) {
+            glfwWaitEventsTimeout(MINIMIZED_POLL_SECONDS);
+        } else {
+            glfwPollEvents();
+        }
+    }
     void LvkWindow::createWindowSurface(VkInstance instance, VkSurfaceKHR *surface){
         if (glfwCreateWindowSurface(instance, window, nullptr, surface)!= VK_SUCCESS){
             throw std::runtime_error("failed to create a window");
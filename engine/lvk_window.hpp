@@ -17,10 +17,16 @@ namespace lvk {
         VkExtent2D getExtent() { return {static_cast<uint32_t>(width), static_cast<uint32_t>(height)}; };
         bool wasWindowResized() { return framebufferResized; }
         void resetWindowResizedFlag() { framebufferResized = false; }
+        bool isMinimized() { return width == 0 || height == 0; }
+        // Processes pending events. While minimized there is nothing to draw, so it sleeps until an
+        // event arrives or a short timeout passes instead of letting the caller spin.
+        void pollEvents();
 
         void createWindowSurface(VkInstance instance, VkSurfaceKHR *surface);
 
     private:
+        static constexpr double MINIMIZED_POLL_SECONDS = 0.1;
+
         static void framebufferResizeCallback(GLFWwindow *window, int width, int height);
         void initWindow();
         int width;
@@ -1,12 +1,15 @@
 #include "simple_render_system.hpp"
+#include "lvk_trace.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <algorithm>
 #include <stdexcept>
 #include <array>
+#include <cassert>
 #include <cstdlib>
 #include <ctime>
 
@@ -19,13 +22,48 @@ namespace lvk {
         alignas(16) glm::vec3 color;
     };
 
-    SimpleRenderSystem::SimpleRenderSystem(LvkDevice &device, VkRenderPass renderPass) : lvkDevice{device} {
+    namespace {
+        // permutation features of shader.frag
+        enum ShaderFeature : uint32_t {
+            FEATURE_PUSH_COLOR = 1u << 0,
+        };
+
+        const LvkShaderPermutations &shaderPermutations() {
+            static const LvkShaderPermutations permutations =
+                    LvkShaderPermutations{}.feature(FEATURE_PUSH_COLOR, 0);
+            return permutations;
+        }
+    }
+
+    SimpleRenderSystem::SimpleRenderSystem(
+            LvkDevice &device,
+            VkRenderPass renderPass,
+            uint32_t framesInFlight,
+            bool instanced,
+            LvkJobSystem *jobSystem)
+            : lvkDevice{device}, instanced{instanced}, jobSystem{jobSystem}, instanceBuffers(framesInFlight) {
+        assert(framesInFlight >= 1 && "render system needs at least one frame in flight");
         createPipelineLayout();
         createPipeline(renderPass);
+        if (jobSystem != nullptr) {
+            // one pool per worker plus one for the thread calling renderGameObjects
+            commandAllocator = std::make_unique<LvkCommandAllocator>(
+                    lvkDevice, jobSystem->workerCount() + 1, framesInFlight);
+        }
     }
 
     SimpleRenderSystem::~SimpleRenderSystem(){
-        vkDestroyPipelineLayout(lvkDevice.device(), pipelineLayout, nullptr);
+        // frames still in flight may be reading the instance data
+        for (auto &instanceBuffer : instanceBuffers) {
+            if (instanceBuffer.buffer != VK_NULL_HANDLE) {
+                lvkDevice.deletionQueue().enqueue(
+                        [device = lvkDevice.device(), &allocator = lvkDevice.allocator(), buffer = instanceBuffer.buffer,
+                         allocation = instanceBuffer.allocation]() mutable {
+                            vkDestroyBuffer(device, buffer, nullptr);
+                            allocator.free(allocation);
+                        });
+            }
+        }
     }
 
     void SimpleRenderSystem::createPipelineLayout() {
@@ -34,16 +72,8 @@ namespace lvk {
         pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
         pushConstantRange.offset = 0;
         pushConstantRange.size = sizeof(SimplePushConstantData);
-
-        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipelineLayoutInfo.setLayoutCount = 0;
-        pipelineLayoutInfo.pSetLayouts = nullptr;
-        pipelineLayoutInfo.pushConstantRangeCount = 1;
-        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-        if (vkCreatePipelineLayout(lvkDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS){
-            throw std::runtime_error("failed to create pipeline info");
-        }
+        // shared through the registry, which also owns it
+        pipelineLayout = lvkDevice.pipelineRegistry().getPipelineLayout({pushConstantRange});
     }
 
     void SimpleRenderSystem::createPipeline(VkRenderPass renderPass) {
@@ -53,30 +83,216 @@ namespace lvk {
         LvkPipeline::defaultPipelineConfigInfo(pipelineConfig);
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
-        lvkPipeline = std::make_unique<LvkPipeline>(
-                lvkDevice,
-                "../shaders/shader.vert.spv",
-                "../shaders/shader.frag.spv",
-                pipelineConfig);
+        auto &registry = lvkDevice.pipelineRegistry();
+        auto requestPipeline = [&](const std::string &vertFilepath, const std::string &fragFilepath, uint32_t features) {
+            pipelineConfig.specialization = shaderPermutations().constants(features);
+            if (jobSystem != nullptr) {
+                return registry.requestPipeline(vertFilepath, fragFilepath, pipelineConfig);
+            }
+            return registry.getPipelineHandle(vertFilepath, fragFilepath, pipelineConfig);
+        };
+        if (!instanced || jobSystem != nullptr) {
+            auto &handle = instanced ? fallbackPipeline : lvkPipeline;
+            handle = requestPipeline("../shaders/shader.vert.spv", "../shaders/shader.frag.spv", FEATURE_PUSH_COLOR);
+            if (!instanced) {
+                return;
+            }
+        }
+
+        VkVertexInputBindingDescription instanceBinding{};
+        instanceBinding.binding = 1;
+        instanceBinding.stride = sizeof(InstanceData);
+        instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+        pipelineConfig.bindingDescriptions.push_back(instanceBinding);
+        pipelineConfig.attributeDescriptions.push_back({2, 1, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(InstanceData, transform)});
+        pipelineConfig.attributeDescriptions.push_back({3, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(InstanceData, offset)});
+        pipelineConfig.attributeDescriptions.push_back({4, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(InstanceData, color)});
+        // same fragment shader, specialized to read the color instanced.vert passes on
+        lvkPipeline = requestPipeline("../shaders/instanced.vert.spv", "../shaders/shader.frag.spv", 0);
     }
 
-    void SimpleRenderSystem::renderGameObjects(VkCommandBuffer commandBuffer, std::vector<LvkGameObject> &gameObjects) {
-        lvkPipeline->bind(commandBuffer);
-        for (auto& obj : gameObjects) {
-            obj.transform2d.rotation = glm::mod(obj.transform2d.rotation + 0.01f, glm::two_pi<float>());
-            SimplePushConstantData push{};
-            push.offset = obj.transform2d.translation;
-            push.color = obj.color;
-            push.transform = obj.transform2d.mat2();
-            vkCmdPushConstants(commandBuffer,
-                               pipelineLayout,
-                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                               0,
-                               sizeof(SimplePushConstantData),
-                               &push);
-            obj.model->bind(commandBuffer);
-            obj.model->draw(commandBuffer);
+    void SimpleRenderSystem::renderGameObjects(FrameInfo &frameInfo, LvkGameObjectStore &gameObjects) {
+        LVK_TRACE_ZONE("renderGameObjects");
+        for (float &rotation : gameObjects.rotations) {
+            rotation = glm::mod(rotation + 0.01f, glm::two_pi<float>());
         }
+        gameObjects.markAllDirty();
+        gameObjects.updateTransforms();
+        if (commandAllocator) {
+            // this frame slot's previous submission has been waited on, so its secondaries can be recycled
+            commandAllocator->beginFrame(frameInfo.frameIndex);
+        }
+        // pipelines still compiling are skipped the same way as models still uploading
+        if (LvkPipeline *pipeline = lvkPipeline.get()) {
+            if (instanced) {
+                renderInstanced(frameInfo, gameObjects, *pipeline);
+            } else {
+                renderIndividually(frameInfo, gameObjects, *pipeline);
+            }
+        } else if (LvkPipeline *fallback = fallbackPipeline.get()) {
+            renderIndividually(frameInfo, gameObjects, *fallback);
+        }
+    }
+
+    void SimpleRenderSystem::renderIndividually(
+            FrameInfo &frameInfo, LvkGameObjectStore &gameObjects, LvkPipeline &pipeline) {
+        // readiness is resolved once up front; slices on other threads only read
+        readyModels.resize(gameObjects.modelCount());
+        for (uint32_t m = 0; m < gameObjects.modelCount(); m++) {
+            readyModels[m] = gameObjects.model(m).isReady() ? 1 : 0;
+        }
+        record(frameInfo, gameObjects.size(), MIN_OBJECTS_PER_SLICE, pipeline, VK_NULL_HANDLE,
+               [&](VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                const LvkGameObjectStore::ModelHandle handle = gameObjects.models[i];
+                if (!readyModels[handle]) continue;
+                LvkModel &model = gameObjects.model(handle);
+                const glm::vec4 &m = gameObjects.transforms[i];
+                SimplePushConstantData push{};
+                push.offset = gameObjects.translations[i];
+                push.color = gameObjects.colors[i];
+                push.transform = glm::mat2{glm::vec2{m.x, m.y}, glm::vec2{m.z, m.w}};
+                vkCmdPushConstants(commandBuffer,
+                                   pipelineLayout,
+                                   VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                   0,
+                                   sizeof(SimplePushConstantData),
+                                   &push);
+                model.bind(commandBuffer);
+                model.draw(commandBuffer);
+            }
+        });
     }
 
+    void SimpleRenderSystem::renderInstanced(
+            FrameInfo &frameInfo, LvkGameObjectStore &gameObjects, LvkPipeline &pipeline) {
+        // group by model handle: count, prefix-sum into per-model cursors, then scatter
+        const uint32_t modelCount = gameObjects.modelCount();
+        batches.assign(modelCount, ModelBatch{0, 0});
+        for (LvkGameObjectStore::ModelHandle handle : gameObjects.models) {
+            batches[handle].instanceCount++;
+        }
+        uint32_t instanceCount = 0;
+        for (uint32_t m = 0; m < modelCount; m++) {
+            if (!gameObjects.model(m).isReady()) {
+                batches[m].instanceCount = 0;
+            }
+            batches[m].firstInstance = instanceCount;
+            instanceCount += batches[m].instanceCount;
+        }
+        if (instanceCount == 0) {
+            return;
+        }
+
+        // this frame slot's previous submission has been waited on, so the GPU is done with its instance buffer
+        InstanceBuffer &instanceBuffer = instanceBuffers[frameInfo.frameIndex];
+        reserveInstances(instanceBuffer, instanceCount);
+        auto *instances = static_cast<InstanceData *>(instanceBuffer.allocation.mapped);
+        cursors.resize(modelCount);
+        for (uint32_t m = 0; m < modelCount; m++) {
+            cursors[m] = batches[m].instanceCount > 0 ? batches[m].firstInstance : INVALID_CURSOR;
+        }
+        for (uint32_t i = 0; i < gameObjects.size(); i++) {
+            uint32_t &cursor = cursors[gameObjects.models[i]];
+            if (cursor == INVALID_CURSOR) continue;
+            instances[cursor++] = InstanceData{
+                    gameObjects.transforms[i],
+                    gameObjects.translations[i],
+                    gameObjects.colors[i]};
+        }
+
+        record(frameInfo, modelCount, MIN_MODELS_PER_SLICE, pipeline, instanceBuffer.buffer,
+               [&](VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end) {
+            for (uint32_t m = begin; m < end; m++) {
+                if (batches[m].instanceCount == 0) continue;
+                LvkModel &model = gameObjects.model(m);
+                model.bind(commandBuffer);
+                model.draw(commandBuffer, batches[m].instanceCount, batches[m].firstInstance);
+            }
+        });
+    }
+
+    void SimpleRenderSystem::record(
+            FrameInfo &frameInfo, uint32_t itemCount, uint32_t minSliceSize, LvkPipeline &pipeline,
+            VkBuffer instanceBuffer, const RecordFn &fn) {
+        if (!commandAllocator) {
+            bindState(frameInfo.commandBuffer, pipeline, instanceBuffer);
+            fn(frameInfo.commandBuffer, 0, itemCount);
+            return;
+        }
+        if (itemCount == 0) {
+            return;
+        }
+
+        const uint32_t threadCount = commandAllocator->threadCount();
+        const uint32_t sliceSize = std::max(minSliceSize, (itemCount + threadCount - 1) / threadCount);
+        secondaries.assign((itemCount + sliceSize - 1) / sliceSize, VK_NULL_HANDLE);
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass = frameInfo.renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = frameInfo.framebuffer;
+
+        VkViewport viewport{};
+        viewport.width = static_cast<float>(frameInfo.extent.width);
+        viewport.height = static_cast<float>(frameInfo.extent.height);
+        viewport.maxDepth = 1.0f;
+        VkRect2D scissor{{0, 0}, frameInfo.extent};
+
+        jobSystem->parallelFor(itemCount, sliceSize, [&](uint32_t begin, uint32_t end) {
+            LVK_TRACE_ZONE("recordSlice");
+            // each thread only ever allocates from its own pool
+            VkCommandBuffer commandBuffer = commandAllocator->allocate(
+                    LvkJobSystem::threadIndex(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            VkCommandBufferBeginInfo beginInfo{};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+            beginInfo.pInheritanceInfo = &inheritanceInfo;
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin secondary command buffer");
+            }
+            // dynamic state is not inherited from the primary buffer
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+            bindState(commandBuffer, pipeline, instanceBuffer);
+            fn(commandBuffer, begin, end);
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record secondary command buffer");
+            }
+            secondaries[begin / sliceSize] = commandBuffer;
+        });
+        vkCmdExecuteCommands(
+                frameInfo.commandBuffer, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+    }
+
+    void SimpleRenderSystem::bindState(VkCommandBuffer commandBuffer, LvkPipeline &pipeline, VkBuffer instanceBuffer) {
+        pipeline.bind(commandBuffer);
+        if (instanceBuffer != VK_NULL_HANDLE) {
+            VkBuffer buffers[] = {instanceBuffer};
+            VkDeviceSize offsets[] = {0};
+            vkCmdBindVertexBuffers(commandBuffer, 1, 1, buffers, offsets);
+        }
+    }
+
+    void SimpleRenderSystem::reserveInstances(InstanceBuffer &instanceBuffer, uint32_t count) {
+        if (count <= instanceBuffer.capacity) {
+            return;
+        }
+        if (instanceBuffer.buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(lvkDevice.device(), instanceBuffer.buffer, nullptr);
+            lvkDevice.allocator().free(instanceBuffer.allocation);
+        }
+        uint32_t capacity = std::max<uint32_t>(instanceBuffer.capacity, 256);
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        lvkDevice.createBuffer(
+                sizeof(InstanceData) * capacity,
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                instanceBuffer.buffer,
+                instanceBuffer.allocation);
+        instanceBuffer.capacity = capacity;
+    }
 }
\ No newline at end of file
@@ -1,29 +1,97 @@
 #pragma once
 
 #include "lvk_pipeline.hpp"
+#include "lvk_pipeline_registry.hpp"
 #include "lvk_device.hpp"
+#include "lvk_command_allocator.hpp"
+#include "lvk_job_system.hpp"
 #include "lvk_model.hpp"
-#include "lvk_game_object.hpp"
+#include "lvk_game_object_store.hpp"
+#include "lvk_frame_info.hpp"
 //std
+#include <functional>
+#include <limits>
 #include <memory>
 #include <vector>
 namespace lvk {
     class SimpleRenderSystem {
     public:
 
-        SimpleRenderSystem(LvkDevice  &device, VkRenderPass renderPass);
+        // framesInFlight must match the renderer's frame policy, as per-frame resources follow
+        // FrameInfo::frameIndex. instanced draws every object sharing a model with one call, reading
+        // per-object data from a per-frame instance buffer; otherwise each object gets its own push
+        // constants and draw.
+        // With a job system, draws are recorded into secondary command buffers on its workers and
+        // pipelines compile in the background on the registry's compile workers. Until the instanced
+        // pipeline is ready objects are drawn individually, and until any pipeline is ready nothing
+        // is drawn.
+        SimpleRenderSystem(
+                LvkDevice &device,
+                VkRenderPass renderPass,
+                uint32_t framesInFlight,
+                bool instanced = true,
+                LvkJobSystem *jobSystem = nullptr);
         ~SimpleRenderSystem();
 
         SimpleRenderSystem(const SimpleRenderSystem &) = delete;
         SimpleRenderSystem &operator=(const SimpleRenderSystem &) = delete;
-        void renderGameObjects(VkCommandBuffer commandBuffer, std::vector<LvkGameObject> &gameObjects);
+        void renderGameObjects(FrameInfo &frameInfo, LvkGameObjectStore &gameObjects);
+        // What the render pass must be begun with for renderGameObjects to record into it.
+        VkSubpassContents subpassContents() const {
+            return commandAllocator ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+        }
     private:
+        struct InstanceData {
+            glm::vec4 transform;
+            glm::vec2 offset;
+            glm::vec3 color;
+        };
+
+        struct InstanceBuffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            LvkAllocation allocation;
+            uint32_t capacity = 0;
+        };
+
+        struct ModelBatch {
+            uint32_t firstInstance;
+            uint32_t instanceCount;
+        };
+
+        using RecordFn = std::function<void(VkCommandBuffer commandBuffer, uint32_t begin, uint32_t end)>;
+
+        static constexpr uint32_t INVALID_CURSOR = std::numeric_limits<uint32_t>::max();
+        // smallest slice worth a secondary command buffer of its own
+        static constexpr uint32_t MIN_OBJECTS_PER_SLICE = 512;
+        static constexpr uint32_t MIN_MODELS_PER_SLICE = 8;
+
         void createPipelineLayout();
         void createPipeline(VkRenderPass renderPass);
+        void renderIndividually(FrameInfo &frameInfo, LvkGameObjectStore &gameObjects, LvkPipeline &pipeline);
+        void renderInstanced(FrameInfo &frameInfo, LvkGameObjectStore &gameObjects, LvkPipeline &pipeline);
+        // Binds state and runs fn over [0, itemCount): inline on the primary buffer, or split into
+        // slices recorded as secondaries on the job system and executed in slice order.
+        void record(FrameInfo &frameInfo, uint32_t itemCount, uint32_t minSliceSize, LvkPipeline &pipeline,
+                    VkBuffer instanceBuffer, const RecordFn &fn);
+        void bindState(VkCommandBuffer commandBuffer, LvkPipeline &pipeline, VkBuffer instanceBuffer);
+        void reserveInstances(InstanceBuffer &instanceBuffer, uint32_t count);
 
         LvkDevice &lvkDevice;
+        bool instanced;
+        LvkJobSystem *jobSystem;
+        std::unique_ptr<LvkCommandAllocator> commandAllocator;
 
-        std::unique_ptr<LvkPipeline> lvkPipeline;
+        LvkPipelineHandle lvkPipeline;
+        // per-object pipeline drawn with while an instanced lvkPipeline is still compiling
+        LvkPipelineHandle fallbackPipeline;
         VkPipelineLayout pipelineLayout;
+
+        // one per frame in flight
+        std::vector<InstanceBuffer> instanceBuffers;
+        // scratch reused across frames so grouping does not allocate once warmed up
+        std::vector<ModelBatch> batches;
+        std::vector<uint32_t> cursors;
+        std::vector<uint8_t> readyModels;
+        std::vector<VkCommandBuffer> secondaries;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,17 @@
+#version 450
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec3 color;
+
+// per instance: the mat2 columns packed as (c0.x, c0.y, c1.x, c1.y)
+layout(location = 2) in vec4 instanceTransform;
+layout(location = 3) in vec2 instanceOffset;
+layout(location = 4) in vec3 instanceColor;
+
+layout(location = 0) out vec3 fragColor;
+
+void main(){
+    mat2 transform = mat2(instanceTransform.xy, instanceTransform.zw);
+    gl_Position = vec4(transform * position + instanceOffset, 0.0, 1.0);
+    fragColor = instanceColor;
+}
@@ -1,5 +1,10 @@
 #version 450
 
+// permutation feature: take the color from push constants rather than the vertex stage
+layout(constant_id = 0) const bool PUSH_COLOR = false;
+
+layout(location = 0) in vec3 fragColor;
+
 layout (location = 0) out vec4 outColor;
 
 layout(push_constant) uniform Push {
@@ -9,5 +14,5 @@ layout(push_constant) uniform Push {
 } push;
 
 void main(){
-    outColor = vec4(push.color, 1.0);
+    outColor = vec4(PUSH_COLOR ? push.color : fragColor, 1.0);
 }
\ No newline at end of file
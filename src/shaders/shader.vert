@@ -3,6 +3,8 @@
 layout(location = 0) in vec2 position;
 layout(location = 1) in vec3 color;
 
+layout(location = 0) out vec3 fragColor;
+
 layout(push_constant) uniform Push {
         mat2 transform;
         vec2 offset;
@@ -11,4 +13,5 @@ layout(push_constant) uniform Push {
 
 void main(){
     gl_Position = vec4(push.transform * position + push.offset, 0.0, 1.0);
+    fragColor = color;
 }
\ No newline at end of file